@@ -7,6 +7,7 @@
 
 #include "Constants.hpp"
 #include "Macros.hpp"
+#include "Instrument.hpp"
 
 #include "Vector2.hpp"
 #include "Vector3.hpp"
@@ -14,6 +15,25 @@
 
 #include "Matrix3x3.hpp"
 #include "Matrix4x4.hpp"
+#include "Views.hpp"
+
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+
+#include "SpatialHash.hpp"
+#include "KDTree.hpp"
+#include "Intersection.hpp"
+#include "Collision.hpp"
+#include "Integrator.hpp"
+#include "FastMath.hpp"
+#include "Decompose.hpp"
+#include "WideMatrix.hpp"
+#include "Morton.hpp"
+#include "Animation.hpp"
+#include "Pipeline.hpp"
+#include "SDF.hpp"
+#include "MeshNormals.hpp"
+#include "Curves.hpp"
 
 namespace FGML {
 	///
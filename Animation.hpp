@@ -0,0 +1,421 @@
+#ifndef FGML_ANIMATION_HPP_
+#define FGML_ANIMATION_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix4x4.hpp"
+#include "Decompose.hpp"
+
+namespace FGML {
+	///
+	///	Definition of AnimationClip class
+	///
+	///	Skeletal clip compressed into per-bone translation, rotation and
+	///	scale tracks. Keys are 16-bit frame numbers with four 16-bit
+	///	components quantized over each track's range. Build drops every key
+	///	that linear interpolation (nlerp for rotations) between its
+	///	neighbours reproduces within the tolerance. Sampling interpolates a
+	///	SimdFloat::Width block of bones at a time.
+	///
+	///	Max reconstruction error per channel, in component units (quaternion
+	///	components for rotations).
+	struct AnimationTolerance {
+		float translation = 1E-3f;
+		float rotation	  = 1E-4f;
+		float scale		  = 1E-3f;
+	};
+
+	const size_t ANIMATION_CHANNELS = 3;
+	const size_t ANIMATION_MAX_FRAMES = 65536;
+	///	Longest run of frames one key pair may span; bounds the build cost.
+	const size_t ANIMATION_MAX_SPAN = 256;
+	///	Keys the cursor walks forward before falling back to a binary search.
+	const size_t ANIMATION_CURSOR_STEPS = 4;
+	///	Bones gathered per pass of the sampler; sizes its stack scratch.
+	const size_t ANIMATION_BONE_GROUP = 64;
+	///	Instances per worker chunk in the batch samplers.
+	const size_t ANIMATION_MIN_CHUNK = 8;
+
+	class AnimationClip;
+
+	///	Per-instance playback state: the key interval each track used last,
+	///	so sequential playback finds the next interval in a step or two.
+	class AnimationCursor {
+	private:
+		std::vector<uint32_t> m_keys;
+
+		friend class AnimationClip;
+	public:
+		AnimationCursor() = default;
+
+		///	Forget the cached intervals, e.g. after a jump or a clip change.
+		inline void Reset(void);
+
+		~AnimationCursor() = default;
+	};
+
+	class AnimationClip {
+	private:
+		struct Track {
+			uint32_t firstKey;
+			uint32_t keyCount;
+			float	 minimum[4];
+			float	 step[4];		// range / 65535
+		};
+
+		float				  m_sampleRate;
+		size_t				  m_frameCount;
+		size_t				  m_boneCount;
+		std::vector<Track>	  m_tracks;		// bone * ANIMATION_CHANNELS + channel
+		std::vector<uint16_t> m_keyFrames;
+		std::vector<uint16_t> m_keyValues;	// four per key; translation and scale leave w at 0
+
+		inline void		BuildTrack(std::vector<float>& values, size_t channel, float tolerance);
+		inline uint32_t LocateKey(const Track& track, float frame, uint32_t key) const;
+		inline float	FrameAt(float time) const;
+
+		template<typename Write>
+		inline void SampleBones(float time, AnimationCursor& cursor, Write&& write) const;
+	public:
+		AnimationClip();
+
+		///	samples holds frameCount poses of boneCount local transforms,
+		///	frame-major, taken at sampleRate frames per second.
+		inline void Build(const Transform* samples, size_t frameCount, size_t boneCount, float sampleRate,
+						  const AnimationTolerance& tolerance = AnimationTolerance());
+
+		///	Local transforms of every bone at time (seconds, clamped to the clip).
+		inline void Sample(float time, AnimationCursor& cursor, Transform* out) const;
+		///	T * R * S matrices of every bone. With parents (parents[b] < b, or
+		///	-1 for a root) the matrices are concatenated into model space.
+		inline void SamplePalette(float time, AnimationCursor& cursor, Matrix4x4* palette,
+								  const int32_t* parents = nullptr) const;
+
+		inline float  Duration(void) const;
+		inline size_t BoneCount(void) const;
+		inline size_t FrameCount(void) const;
+		inline size_t KeyCount(void) const;
+		inline size_t SizeInBytes(void) const;
+
+		~AnimationClip() = default;
+	};
+	///
+	///	Definition of AnimationClip class end
+	///
+
+	///
+	///	Declaration of AnimationClip methods
+	///
+	inline void AnimationCursor::Reset(void){
+		this->m_keys.clear();
+	}
+
+	inline AnimationClip::AnimationClip()
+	: m_sampleRate(1.0f), m_frameCount(0), m_boneCount(0) {}
+
+	inline void AnimationClip::Build(const Transform* samples, size_t frameCount, size_t boneCount, float sampleRate,
+									 const AnimationTolerance& tolerance){
+		assert(frameCount > 0 && frameCount <= ANIMATION_MAX_FRAMES && "Frame count must fit 16-bit key frames");
+		assert(sampleRate > 0.0f && "Sample rate must be positive");
+
+		this->m_sampleRate = sampleRate;
+		this->m_frameCount = frameCount;
+		this->m_boneCount  = boneCount;
+		this->m_tracks.clear();
+		this->m_keyFrames.clear();
+		this->m_keyValues.clear();
+		this->m_tracks.reserve(boneCount * ANIMATION_CHANNELS);
+
+		const float tolerances[ANIMATION_CHANNELS] = { tolerance.translation, tolerance.rotation, tolerance.scale };
+		std::vector<float> values(frameCount * 4);
+
+		for (size_t bone = 0; bone < boneCount; ++bone){
+			for (size_t channel = 0; channel < ANIMATION_CHANNELS; ++channel){
+				for (size_t f = 0; f < frameCount; ++f){
+					const Transform& t = samples[f * boneCount + bone];
+					float* v = &values[f * 4];
+					if (channel == 1){
+						v[0] = getXComponent(t.rotation); v[1] = getYComponent(t.rotation);
+						v[2] = getZComponent(t.rotation); v[3] = getWComponent(t.rotation);
+						// Keep neighbouring keys in one hemisphere so nlerp takes the short arc.
+						if (f > 0 && v[0] * v[-4] + v[1] * v[-3] + v[2] * v[-2] + v[3] * v[-1] < 0.0f)
+							for (size_t c = 0; c < 4; ++c) v[c] = -v[c];
+					}
+					else {
+						const Vector3& source = (channel == 0) ? t.translation : t.scale;
+						v[0] = getXComponent(source); v[1] = getYComponent(source);
+						v[2] = getZComponent(source); v[3] = 0.0f;
+					}
+				}
+				this->BuildTrack(values, channel, tolerances[channel]);
+			}
+		}
+	}
+
+	inline void AnimationClip::BuildTrack(std::vector<float>& values, size_t channel, float tolerance){
+		const size_t frameCount = this->m_frameCount;
+		Track track;
+		track.firstKey = static_cast<uint32_t>(this->m_keyFrames.size());
+
+		// Quantize first so the reduction measures the error of the stored keys.
+		std::vector<uint16_t> quantized(frameCount * 4);
+		std::vector<float>	  decoded(frameCount * 4);
+		for (size_t c = 0; c < 4; ++c){
+			float lo = values[c], hi = values[c];
+			for (size_t f = 1; f < frameCount; ++f){
+				lo = MIN(lo, values[f * 4 + c]);
+				hi = MAX(hi, values[f * 4 + c]);
+			}
+			track.minimum[c] = lo;
+			track.step[c]	 = (hi - lo) / 65535.0f;
+			const float inverse = (hi > lo) ? 65535.0f / (hi - lo) : 0.0f;
+			for (size_t f = 0; f < frameCount; ++f){
+				const float q = std::floor((values[f * 4 + c] - lo) * inverse + 0.5f);
+				quantized[f * 4 + c] = static_cast<uint16_t>(MIN(MAX(q, 0.0f), 65535.0f));
+				decoded[f * 4 + c]	 = lo + static_cast<float>(quantized[f * 4 + c]) * track.step[c];
+			}
+		}
+
+		// Interpolating decoded keys a and b must reproduce every frame between them.
+		auto fits = [&](size_t a, size_t b){
+			for (size_t f = a + 1; f < b; ++f){
+				const float alpha = static_cast<float>(f - a) / static_cast<float>(b - a);
+				float v[4], lengthSq = 0.0f;
+				for (size_t c = 0; c < 4; ++c){
+					v[c] = decoded[a * 4 + c] + (decoded[b * 4 + c] - decoded[a * 4 + c]) * alpha;
+					lengthSq += v[c] * v[c];
+				}
+				const float scale = (channel == 1 && lengthSq > 0.0f) ? 1.0f / std::sqrt(lengthSq) : 1.0f;
+				for (size_t c = 0; c < 4; ++c)
+					if (std::fabs(v[c] * scale - values[f * 4 + c]) > tolerance) return false;
+			}
+			return true;
+		};
+
+		auto emit = [&](size_t f){
+			this->m_keyFrames.push_back(static_cast<uint16_t>(f));
+			for (size_t c = 0; c < 4; ++c) this->m_keyValues.push_back(quantized[f * 4 + c]);
+		};
+
+		bool constant = true;
+		for (size_t f = 1; f < frameCount && constant; ++f)
+			for (size_t c = 0; c < 4; ++c)
+				if (std::fabs(decoded[c] - values[f * 4 + c]) > tolerance) constant = false;
+
+		emit(0);
+		if (!constant){
+			// Greedy: extend each segment while the skipped frames still fit.
+			for (size_t start = 0; start + 1 < frameCount; ){
+				size_t end = start + 1;
+				while (end + 1 < frameCount && end + 1 - start <= ANIMATION_MAX_SPAN && fits(start, end + 1)) ++end;
+				emit(end);
+				start = end;
+			}
+		}
+		track.keyCount = static_cast<uint32_t>(this->m_keyFrames.size()) - track.firstKey;
+		this->m_tracks.push_back(track);
+	}
+
+	///	Start of the key interval containing frame, starting the search at
+	///	the cursor's key.
+	inline uint32_t AnimationClip::LocateKey(const Track& track, float frame, uint32_t key) const {
+		if (track.keyCount < 2) return 0;
+		const uint16_t* frames = &this->m_keyFrames[track.firstKey];
+		const uint32_t last = track.keyCount - 2;
+
+		if (key <= last && static_cast<float>(frames[key]) <= frame){
+			for (size_t steps = 0; steps <= ANIMATION_CURSOR_STEPS; ++steps){
+				if (key == last || frame < static_cast<float>(frames[key + 1])) return key;
+				++key;
+			}
+		}
+
+		const uint16_t* upper = std::upper_bound(frames, frames + track.keyCount, frame,
+												  [](float value, uint16_t f){ return value < static_cast<float>(f); });
+		const uint32_t found = static_cast<uint32_t>(upper - frames);
+		return (found == 0) ? 0 : MIN(found - 1, last);
+	}
+
+	inline float AnimationClip::FrameAt(float time) const {
+		const float frame = time * this->m_sampleRate;
+		return MIN(MAX(frame, 0.0f), static_cast<float>(this->m_frameCount - 1));
+	}
+
+	///	Works in groups of ANIMATION_BONE_GROUP bones, two passes each. A
+	///	scalar pass locates each track's keys and gathers the dequantized
+	///	pair and blend factor into SoA rows; the SimdFloat pass then
+	///	interpolates and normalizes a block of bones at a time and hands
+	///	write(firstBone, lanes, t, r, s) the channel registers. Splitting
+	///	the passes keeps the vector loads clear of the scalar stores that
+	///	just filled them.
+	template<typename Write>
+	inline void AnimationClip::SampleBones(float time, AnimationCursor& cursor, Write&& write) const {
+		const size_t Width = SimdFloat::Width;
+		static_assert(ANIMATION_BONE_GROUP % SimdFloat::Width == 0, "Bone groups must hold whole SIMD blocks");
+		if (cursor.m_keys.size() != this->m_tracks.size()) cursor.m_keys.assign(this->m_tracks.size(), 0);
+		const float frame = this->FrameAt(time);
+
+		// Rows 0-11: first keys, 12-23: second keys, 24-26: blend factors.
+		alignas(32) float rows[ANIMATION_CHANNELS * 9][ANIMATION_BONE_GROUP];
+
+		for (size_t group = 0; group < this->m_boneCount; group += ANIMATION_BONE_GROUP){
+			const size_t groupSize = MIN(ANIMATION_BONE_GROUP, this->m_boneCount - group);
+
+			for (size_t b = 0; b < groupSize; ++b){
+				for (size_t channel = 0; channel < ANIMATION_CHANNELS; ++channel){
+					const size_t t = (group + b) * ANIMATION_CHANNELS + channel;
+					const Track& track = this->m_tracks[t];
+					const uint32_t key	= this->LocateKey(track, frame, cursor.m_keys[t]);
+					const uint32_t next = MIN(key + 1, track.keyCount - 1);
+					cursor.m_keys[t] = key;
+
+					const size_t k0 = track.firstKey + key, k1 = track.firstKey + next;
+					const float f0 = this->m_keyFrames[k0], f1 = this->m_keyFrames[k1];
+					rows[24 + channel][b] = (f1 > f0) ? MIN(MAX((frame - f0) / (f1 - f0), 0.0f), 1.0f) : 0.0f;
+					for (size_t c = 0; c < 4; ++c){
+						rows[channel * 4 + c][b]	  = track.minimum[c] + this->m_keyValues[k0 * 4 + c] * track.step[c];
+						rows[12 + channel * 4 + c][b] = track.minimum[c] + this->m_keyValues[k1 * 4 + c] * track.step[c];
+					}
+				}
+			}
+			// Pad the last block with copies of the group's first bone.
+			for (size_t b = groupSize; b % Width != 0; ++b)
+				for (size_t row = 0; row < ANIMATION_CHANNELS * 9; ++row) rows[row][b] = rows[row][0];
+
+			for (size_t first = 0; first < groupSize; first += Width){
+				SimdFloat value[ANIMATION_CHANNELS][4];
+				for (size_t channel = 0; channel < ANIMATION_CHANNELS; ++channel){
+					const SimdFloat alpha = SimdFloat::LoadAligned(rows[24 + channel] + first);
+					for (size_t c = 0; c < 4; ++c){
+						const SimdFloat v0 = SimdFloat::LoadAligned(rows[channel * 4 + c] + first);
+						const SimdFloat v1 = SimdFloat::LoadAligned(rows[12 + channel * 4 + c] + first);
+						value[channel][c] = MulAdd(v1 - v0, alpha, v0);
+					}
+				}
+
+				// nlerp, flipped to w >= 0 to match Transform.
+				SimdFloat (&r)[4] = value[1];
+				const SimdFloat lengthSq = MulAdd(r[0], r[0], MulAdd(r[1], r[1], MulAdd(r[2], r[2], r[3] * r[3])));
+				const SimdFloat magnitude = Sqrt(Max(lengthSq, SimdFloat(1E-30f)));
+				const SimdFloat inverse = Select(CmpLt(r[3], SimdFloat::Zero()), SimdFloat(-1.0f), SimdFloat(1.0f)) / magnitude;
+				for (size_t c = 0; c < 4; ++c) r[c] *= inverse;
+
+				write(group + first, MIN(Width, groupSize - first), value[0], value[1], value[2]);
+			}
+		}
+	}
+
+	inline void AnimationClip::Sample(float time, AnimationCursor& cursor, Transform* out) const {
+		this->SampleBones(time, cursor, [out](size_t first, size_t lanes, const SimdFloat (&t)[4],
+											  const SimdFloat (&r)[4], const SimdFloat (&s)[4]){
+			alignas(32) float e[10][SimdFloat::Width];
+			const SimdFloat* source[10] = { &t[0], &t[1], &t[2], &r[0], &r[1], &r[2], &r[3], &s[0], &s[1], &s[2] };
+			for (size_t k = 0; k < 10; ++k) source[k]->StoreAligned(e[k]);
+			for (size_t l = 0; l < lanes; ++l){
+				Transform& bone = out[first + l];
+				bone.translation = Vector3(e[0][l], e[1][l], e[2][l]);
+				bone.rotation	 = Vector4(e[3][l], e[4][l], e[5][l], e[6][l]);
+				bone.scale		 = Vector3(e[7][l], e[8][l], e[9][l]);
+			}
+		});
+	}
+
+	inline void AnimationClip::SamplePalette(float time, AnimationCursor& cursor, Matrix4x4* palette,
+											 const int32_t* parents) const {
+		this->SampleBones(time, cursor, [palette](size_t first, size_t lanes, const SimdFloat (&t)[4],
+												  const SimdFloat (&r)[4], const SimdFloat (&s)[4]){
+			// Quaternion to matrix with scaled columns, as in ComposeFrom.
+			const SimdFloat one(1.0f), two(2.0f);
+			const SimdFloat x = r[0], y = r[1], z = r[2], w = r[3];
+			const SimdFloat xx = x * x, yy = y * y, zz = z * z;
+			const SimdFloat xy = x * y, xz = x * z, yz = y * z, wx = w * x, wy = w * y, wz = w * z;
+
+			alignas(32) float e[12][SimdFloat::Width];
+			(( one - two * (yy + zz)) * s[0]).StoreAligned(e[0]);
+			(( two * (xy - wz))		  * s[1]).StoreAligned(e[1]);
+			(( two * (xz + wy))		  * s[2]).StoreAligned(e[2]);
+			t[0].StoreAligned(e[3]);
+			(( two * (xy + wz))		  * s[0]).StoreAligned(e[4]);
+			(( one - two * (xx + zz)) * s[1]).StoreAligned(e[5]);
+			(( two * (yz - wx))		  * s[2]).StoreAligned(e[6]);
+			t[1].StoreAligned(e[7]);
+			(( two * (xz - wy))		  * s[0]).StoreAligned(e[8]);
+			(( two * (yz + wx))		  * s[1]).StoreAligned(e[9]);
+			(( one - two * (xx + yy)) * s[2]).StoreAligned(e[10]);
+			t[2].StoreAligned(e[11]);
+
+			for (size_t l = 0; l < lanes; ++l)
+				palette[first + l] = Matrix4x4( e[0][l], e[1][l], e[2][l],	e[3][l],
+												e[4][l], e[5][l], e[6][l],	e[7][l],
+												e[8][l], e[9][l], e[10][l], e[11][l],
+												0.0f,	 0.0f,	  0.0f,		1.0f );
+		});
+
+		if (parents == nullptr) return;
+		for (size_t bone = 0; bone < this->m_boneCount; ++bone){
+			if (parents[bone] < 0) continue;
+			assert(static_cast<size_t>(parents[bone]) < bone && "Parents must precede their children");
+			palette[bone] = palette[parents[bone]] * palette[bone];
+		}
+	}
+
+	inline float AnimationClip::Duration(void) const {
+		return (this->m_frameCount > 1) ? static_cast<float>(this->m_frameCount - 1) / this->m_sampleRate : 0.0f;
+	}
+
+	inline size_t AnimationClip::BoneCount(void) const	{ return this->m_boneCount; }
+
+	inline size_t AnimationClip::FrameCount(void) const { return this->m_frameCount; }
+
+	inline size_t AnimationClip::KeyCount(void) const	{ return this->m_keyFrames.size(); }
+
+	inline size_t AnimationClip::SizeInBytes(void) const {
+		return this->m_tracks.size() * sizeof(Track)
+			 + this->m_keyFrames.size() * sizeof(uint16_t)
+			 + this->m_keyValues.size() * sizeof(uint16_t);
+	}
+	///
+	///	Declaration of AnimationClip methods end
+	///
+
+	///
+	///	Batch entry points
+	///
+	///	Samples instanceCount instances of one clip, each at its own time
+	///	with its own cursor. out holds BoneCount() transforms per instance.
+	inline void SampleBatch(const AnimationClip& clip, const float* times, AnimationCursor* cursors,
+							size_t instanceCount, Transform* out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(AnimationSampleBatch);
+		const size_t bones = clip.BoneCount();
+		ParallelFor(instanceCount, ANIMATION_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i) clip.Sample(times[i], cursors[i], out + i * bones);
+		}, threadCount);
+	}
+
+	///	As SampleBatch, writing BoneCount() palette matrices per instance.
+	inline void SamplePaletteBatch(const AnimationClip& clip, const float* times, AnimationCursor* cursors,
+								   size_t instanceCount, Matrix4x4* palettes, const int32_t* parents = nullptr,
+								   size_t threadCount = 0){
+		FGML_SCOPED_TIMER(AnimationPaletteBatch);
+		const size_t bones = clip.BoneCount();
+		ParallelFor(instanceCount, ANIMATION_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i) clip.SamplePalette(times[i], cursors[i], palettes + i * bones, parents);
+		}, threadCount);
+	}
+	///
+	///	Batch entry points end
+	///
+};
+
+#endif // FGML_ANIMATION_HPP_
\ No newline at end of file
@@ -0,0 +1,820 @@
+#ifndef FGML_COLLISION_HPP_
+#define FGML_COLLISION_HPP_
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Matrix3x3.hpp"
+
+namespace FGML {
+	///
+	///	Definition of collision shapes
+	///
+	///	Every Collide* routine reports a unit normal pointing from A towards B
+	///	and a positive penetration depth; moving B by normal * depth separates
+	///	the pair.
+	///
+	struct Sphere {
+		Vector3 center;
+		float	radius;
+	};
+
+	struct Capsule {
+		Vector3 a;
+		Vector3 b;
+		float	radius;
+	};
+
+	///	Orientation columns are the box's local axes in world space.
+	struct OBB {
+		Vector3	  center;
+		Matrix3x3 orientation;
+		Vector3	  halfExtents;
+	};
+
+	///	Non-owning convex point cloud for GJK/EPA.
+	struct ConvexPoints {
+		const Vector3* points;
+		size_t		   count;
+	};
+
+	///	Narrow-phase results for a batch of pairs, one entry per pair.
+	struct ContactSoA {
+		std::vector<float>	 normalX;
+		std::vector<float>	 normalY;
+		std::vector<float>	 normalZ;
+		std::vector<float>	 depth;
+		std::vector<uint8_t> hit;
+
+		inline void Resize(size_t count);
+		inline void Set(size_t i, bool isHit, const Vector3& normal, float penetration);
+	};
+	///
+	///	Definition of collision shapes end
+	///
+
+	inline void ContactSoA::Resize(size_t count){
+		this->normalX.resize(count);
+		this->normalY.resize(count);
+		this->normalZ.resize(count);
+		this->depth.resize(count);
+		this->hit.resize(count);
+	}
+
+	inline void ContactSoA::Set(size_t i, bool isHit, const Vector3& normal, float penetration){
+		this->normalX[i] = isHit ? getXComponent(normal) : 0.0f;
+		this->normalY[i] = isHit ? getYComponent(normal) : 0.0f;
+		this->normalZ[i] = isHit ? getZComponent(normal) : 0.0f;
+		this->depth[i]	 = isHit ? penetration : 0.0f;
+		this->hit[i]	 = isHit ? 1 : 0;
+	}
+
+	///
+	///	Closest-point routines
+	///
+	inline Vector3 ClosestPointOnSegment(const Vector3& p, const Vector3& a, const Vector3& b){
+		const Vector3 ab = b - a;
+		const float lengthSq = DotProduct(ab, ab);
+		if (lengthSq <= EPSILON) return a;
+
+		const float t = DotProduct(p - a, ab) / lengthSq;
+		return a + ab * MAX(0.0f, MIN(1.0f, t));
+	}
+
+	///	Closest points between segments p1q1 and p2q2; returns their squared distance.
+	inline float ClosestPointsSegmentSegment(const Vector3& p1, const Vector3& q1,
+											 const Vector3& p2, const Vector3& q2,
+											 Vector3& c1, Vector3& c2){
+		const Vector3 d1 = q1 - p1;
+		const Vector3 d2 = q2 - p2;
+		const Vector3 r	 = p1 - p2;
+		const float a = DotProduct(d1, d1);
+		const float e = DotProduct(d2, d2);
+		const float f = DotProduct(d2, r);
+
+		float s, t;
+		if (a <= EPSILON && e <= EPSILON){
+			s = t = 0.0f;
+		} else if (a <= EPSILON){
+			s = 0.0f;
+			t = MAX(0.0f, MIN(1.0f, f / e));
+		} else {
+			const float c = DotProduct(d1, r);
+			if (e <= EPSILON){
+				t = 0.0f;
+				s = MAX(0.0f, MIN(1.0f, -c / a));
+			} else {
+				const float b = DotProduct(d1, d2);
+				const float denom = a * e - b * b;
+				s = (denom != 0.0f) ? MAX(0.0f, MIN(1.0f, (b * f - c * e) / denom)) : 0.0f;
+				t = (b * s + f) / e;
+
+				if (t < 0.0f){
+					t = 0.0f;
+					s = MAX(0.0f, MIN(1.0f, -c / a));
+				} else if (t > 1.0f){
+					t = 1.0f;
+					s = MAX(0.0f, MIN(1.0f, (b - c) / a));
+				}
+			}
+		}
+
+		c1 = p1 + d1 * s;
+		c2 = p2 + d2 * t;
+		const Vector3 diff = c1 - c2;
+		return DotProduct(diff, diff);
+	}
+
+	inline Vector3 ClosestPointOnOBB(const Vector3& p, const OBB& box){
+		const Vector3 d = p - box.center;
+		const float half[3] = { getXComponent(box.halfExtents), getYComponent(box.halfExtents), getZComponent(box.halfExtents) };
+
+		Vector3 result = box.center;
+		for (size_t i = 0; i < 3; ++i){
+			const Vector3 axis = getColumn(box.orientation, i);
+			const float dist = DotProduct(d, axis);
+			result = result + axis * MAX(-half[i], MIN(half[i], dist));
+		}
+		return result;
+	}
+	///
+	///	Closest-point routines end
+	///
+
+	///
+	///	Primitive pair tests
+	///
+	///	Shared by the sphere and capsule tests: spheres of radius ra/rb at pa/pb.
+	inline bool ContactPointPoint(const Vector3& pa, float ra, const Vector3& pb, float rb,
+								  Vector3& normal, float& depth){
+		const Vector3 d = pb - pa;
+		const float distSq = DotProduct(d, d);
+		const float radii = ra + rb;
+		if (distSq > SQR(radii)) return false;
+
+		const float dist = std::sqrt(distSq);
+		normal = (dist > EPSILON) ? d / dist : Vector3(0.0f, 1.0f, 0.0f);
+		depth  = radii - dist;
+		return true;
+	}
+
+	inline bool CollideSphereSphere(const Sphere& a, const Sphere& b, Vector3& normal, float& depth){
+		return ContactPointPoint(a.center, a.radius, b.center, b.radius, normal, depth);
+	}
+
+	inline bool CollideSphereCapsule(const Sphere& a, const Capsule& b, Vector3& normal, float& depth){
+		const Vector3 closest = ClosestPointOnSegment(a.center, b.a, b.b);
+		return ContactPointPoint(a.center, a.radius, closest, b.radius, normal, depth);
+	}
+
+	inline bool CollideCapsuleCapsule(const Capsule& a, const Capsule& b, Vector3& normal, float& depth){
+		Vector3 ca = a.a, cb = b.a;
+		ClosestPointsSegmentSegment(a.a, a.b, b.a, b.b, ca, cb);
+		return ContactPointPoint(ca, a.radius, cb, b.radius, normal, depth);
+	}
+
+	inline bool CollideSphereOBB(const Sphere& a, const OBB& b, Vector3& normal, float& depth){
+		const Vector3 closest = ClosestPointOnOBB(a.center, b);
+		const Vector3 d = closest - a.center;
+		const float distSq = DotProduct(d, d);
+		if (distSq > SQR(a.radius)) return false;
+
+		if (distSq > EPSILON * EPSILON){
+			const float dist = std::sqrt(distSq);
+			normal = d / dist;
+			depth  = a.radius - dist;
+			return true;
+		}
+
+		// Centre inside the box: push out through the nearest face.
+		const Vector3 local = a.center - b.center;
+		const float half[3] = { getXComponent(b.halfExtents), getYComponent(b.halfExtents), getZComponent(b.halfExtents) };
+		float best = std::numeric_limits<float>::max();
+		for (size_t i = 0; i < 3; ++i){
+			const Vector3 axis = getColumn(b.orientation, i);
+			const float dist = DotProduct(local, axis);
+			const float gap = half[i] - std::fabs(dist);
+			if (gap < best){
+				best   = gap;
+				normal = (dist > 0.0f) ? -axis : axis;
+			}
+		}
+		depth = best + a.radius;
+		return true;
+	}
+
+	///	Separating-axis test over the 15 candidate axes; reports the axis of least overlap.
+	inline bool CollideOBBOBB(const OBB& a, const OBB& b, Vector3& normal, float& depth){
+		const Vector3 axesA[3] = { getColumn(a.orientation, 0), getColumn(a.orientation, 1), getColumn(a.orientation, 2) };
+		const Vector3 axesB[3] = { getColumn(b.orientation, 0), getColumn(b.orientation, 1), getColumn(b.orientation, 2) };
+		const float halfA[3] = { getXComponent(a.halfExtents), getYComponent(a.halfExtents), getZComponent(a.halfExtents) };
+		const float halfB[3] = { getXComponent(b.halfExtents), getYComponent(b.halfExtents), getZComponent(b.halfExtents) };
+		const Vector3 d = b.center - a.center;
+
+		float bestOverlap = std::numeric_limits<float>::max();
+		Vector3 bestAxis = axesA[0];
+
+		auto testAxis = [&](const Vector3& axis) -> bool {
+			const float lengthSq = DotProduct(axis, axis);
+			if (lengthSq < EPSILON) return true;	// parallel edges; covered by the face axes
+
+			const Vector3 l = axis / std::sqrt(lengthSq);
+			float ra = 0.0f, rb = 0.0f;
+			for (size_t i = 0; i < 3; ++i){
+				ra += halfA[i] * std::fabs(DotProduct(axesA[i], l));
+				rb += halfB[i] * std::fabs(DotProduct(axesB[i], l));
+			}
+
+			const float dist = DotProduct(d, l);
+			const float overlap = ra + rb - std::fabs(dist);
+			if (overlap < 0.0f) return false;
+
+			if (overlap < bestOverlap){
+				bestOverlap = overlap;
+				bestAxis	= (dist < 0.0f) ? -l : l;
+			}
+			return true;
+		};
+
+		for (size_t i = 0; i < 3; ++i){
+			if (!testAxis(axesA[i])) return false;
+		}
+		for (size_t i = 0; i < 3; ++i){
+			if (!testAxis(axesB[i])) return false;
+		}
+		for (size_t i = 0; i < 3; ++i){
+			for (size_t j = 0; j < 3; ++j){
+				if (!testAxis(CrossProduct(axesA[i], axesB[j]))) return false;
+			}
+		}
+
+		normal = bestAxis;
+		depth  = bestOverlap;
+		return true;
+	}
+	///
+	///	Primitive pair tests end
+	///
+
+	///
+	///	Support functions for GJK/EPA
+	///
+	inline Vector3 Support(const Sphere& s, const Vector3& dir){
+		const float lengthSq = DotProduct(dir, dir);
+		if (lengthSq <= 0.0f) return s.center;
+		return s.center + dir * (s.radius / std::sqrt(lengthSq));
+	}
+
+	inline Vector3 Support(const Capsule& c, const Vector3& dir){
+		const Vector3 end = (DotProduct(c.b - c.a, dir) > 0.0f) ? c.b : c.a;
+		return Support(Sphere{ end, c.radius }, dir);
+	}
+
+	inline Vector3 Support(const OBB& box, const Vector3& dir){
+		const float half[3] = { getXComponent(box.halfExtents), getYComponent(box.halfExtents), getZComponent(box.halfExtents) };
+		Vector3 result = box.center;
+		for (size_t i = 0; i < 3; ++i){
+			const Vector3 axis = getColumn(box.orientation, i);
+			result = result + axis * ((DotProduct(axis, dir) >= 0.0f) ? half[i] : -half[i]);
+		}
+		return result;
+	}
+
+	inline Vector3 Support(const ConvexPoints& hull, const Vector3& dir){
+		assert(hull.count > 0 && "Empty convex hull");
+		size_t best = 0;
+		float bestDot = DotProduct(hull.points[0], dir);
+		for (size_t i = 1; i < hull.count; ++i){
+			const float dot = DotProduct(hull.points[i], dir);
+			if (dot > bestDot){
+				bestDot = dot;
+				best	= i;
+			}
+		}
+		return hull.points[best];
+	}
+
+	template<typename ShapeA, typename ShapeB>
+	inline Vector3 MinkowskiSupport(const ShapeA& a, const ShapeB& b, const Vector3& dir){
+		return Support(a, dir) - Support(b, -dir);
+	}
+	///
+	///	Support functions end
+	///
+
+	///
+	///	GJK/EPA
+	///
+	struct GJKSimplex {
+		Vector3 points[4] = { Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 0.0f),
+							  Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 0.0f) };
+		size_t	size = 0;
+	};
+
+	inline bool GJKSameDirection(const Vector3& a, const Vector3& b){
+		return DotProduct(a, b) > 0.0f;
+	}
+
+	inline bool GJKLine(GJKSimplex& s, Vector3& dir){
+		const Vector3 a = s.points[0], b = s.points[1];
+		const Vector3 ab = b - a, ao = -a;
+		if (GJKSameDirection(ab, ao)){
+			dir = CrossProduct(CrossProduct(ab, ao), ab);
+		} else {
+			s.size = 1;
+			dir = ao;
+		}
+		return false;
+	}
+
+	inline bool GJKTriangle(GJKSimplex& s, Vector3& dir){
+		const Vector3 a = s.points[0], b = s.points[1], c = s.points[2];
+		const Vector3 ab = b - a, ac = c - a, ao = -a;
+		const Vector3 abc = CrossProduct(ab, ac);
+
+		if (GJKSameDirection(CrossProduct(abc, ac), ao)){
+			if (GJKSameDirection(ac, ao)){
+				s.points[1] = c;
+				s.size = 2;
+				dir = CrossProduct(CrossProduct(ac, ao), ac);
+				return false;
+			}
+			s.size = 2;
+			return GJKLine(s, dir);
+		}
+		if (GJKSameDirection(CrossProduct(ab, abc), ao)){
+			s.size = 2;
+			return GJKLine(s, dir);
+		}
+		if (GJKSameDirection(abc, ao)){
+			dir = abc;
+		} else {
+			s.points[1] = c;
+			s.points[2] = b;
+			dir = -abc;
+		}
+		return false;
+	}
+
+	inline bool GJKTetrahedron(GJKSimplex& s, Vector3& dir){
+		const Vector3 a = s.points[0], b = s.points[1], c = s.points[2], d = s.points[3];
+		const Vector3 ab = b - a, ac = c - a, ad = d - a, ao = -a;
+
+		if (GJKSameDirection(CrossProduct(ab, ac), ao)){
+			s.size = 3;
+			return GJKTriangle(s, dir);
+		}
+		if (GJKSameDirection(CrossProduct(ac, ad), ao)){
+			s.points[1] = c;
+			s.points[2] = d;
+			s.size = 3;
+			return GJKTriangle(s, dir);
+		}
+		if (GJKSameDirection(CrossProduct(ad, ab), ao)){
+			s.points[1] = d;
+			s.points[2] = b;
+			s.size = 3;
+			return GJKTriangle(s, dir);
+		}
+		return true;
+	}
+
+	///	Boolean GJK. On overlap the simplex is kept for EPA.
+	template<typename ShapeA, typename ShapeB>
+	inline bool GJKIntersect(const ShapeA& a, const ShapeB& b, GJKSimplex& simplex, size_t maxIterations = 64){
+		Vector3 dir(1.0f, 0.0f, 0.0f);
+		simplex.points[0] = MinkowskiSupport(a, b, dir);
+		simplex.size = 1;
+		dir = -simplex.points[0];
+
+		for (size_t iter = 0; iter < maxIterations; ++iter){
+			if (DotProduct(dir, dir) < EPSILON * EPSILON) return true;	// origin on the simplex
+
+			const Vector3 p = MinkowskiSupport(a, b, dir);
+			if (DotProduct(p, dir) <= 0.0f) return false;
+
+			for (size_t i = simplex.size; i > 0; --i) simplex.points[i] = simplex.points[i - 1];
+			simplex.points[0] = p;
+			++simplex.size;
+
+			bool contains = false;
+			switch (simplex.size){
+				case 2: contains = GJKLine(simplex, dir);		  break;
+				case 3: contains = GJKTriangle(simplex, dir);	  break;
+				case 4: contains = GJKTetrahedron(simplex, dir); break;
+			}
+			if (contains) return true;
+		}
+		return false;
+	}
+
+	///	Expanding polytope from a GJK simplex; returns the minimum translation normal and depth.
+	template<typename ShapeA, typename ShapeB>
+	inline bool EPAPenetration(const ShapeA& a, const ShapeB& b, const GJKSimplex& simplex,
+							   Vector3& normal, float& depth, size_t maxIterations = 64, float tolerance = 1E-4f){
+		std::vector<Vector3> polytope(simplex.points, simplex.points + simplex.size);
+
+		// GJK may stop early with a touching contact; grow to a tetrahedron first.
+		const Vector3 probes[6] = { Vector3( 1.0f, 0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f),
+									Vector3( 0.0f, 1.0f, 0.0f), Vector3( 0.0f,-1.0f, 0.0f),
+									Vector3( 0.0f, 0.0f, 1.0f), Vector3( 0.0f, 0.0f,-1.0f) };
+		for (size_t i = 0; i < 6 && polytope.size() < 4; ++i){
+			const Vector3 p = MinkowskiSupport(a, b, probes[i]);
+			bool independent = true;
+			if (polytope.size() == 1){
+				const Vector3 d = p - polytope[0];
+				independent = DotProduct(d, d) > EPSILON;
+			} else if (polytope.size() == 2){
+				const Vector3 c = CrossProduct(polytope[1] - polytope[0], p - polytope[0]);
+				independent = DotProduct(c, c) > EPSILON;
+			} else if (polytope.size() == 3){
+				const Vector3 n = CrossProduct(polytope[1] - polytope[0], polytope[2] - polytope[0]);
+				independent = std::fabs(DotProduct(n, p - polytope[0])) > EPSILON;
+			}
+			if (independent) polytope.push_back(p);
+		}
+		if (polytope.size() < 4) return false;
+
+		std::vector<uint32_t> faces = { 0, 1, 2,  0, 3, 1,  0, 2, 3,  1, 3, 2 };
+		std::vector<Vector3>  normals;
+		std::vector<float>	  distances;
+
+		auto faceNormal = [&](size_t f, Vector3& n, float& dist) -> bool {
+			const Vector3& p0 = polytope[faces[f * 3]];
+			const Vector3 c = CrossProduct(polytope[faces[f * 3 + 1]] - p0, polytope[faces[f * 3 + 2]] - p0);
+			const float lengthSq = DotProduct(c, c);
+			if (lengthSq <= 0.0f) return false;
+
+			n = c / std::sqrt(lengthSq);
+			dist = DotProduct(n, p0);
+			if (dist < 0.0f){
+				n = -n;
+				dist = -dist;
+			}
+			return true;
+		};
+
+		auto rebuildNormals = [&](){
+			normals.clear();
+			distances.clear();
+			for (size_t f = 0; f < faces.size() / 3; ++f){
+				Vector3 n(0.0f, 0.0f, 0.0f);
+				float dist = std::numeric_limits<float>::max();
+				faceNormal(f, n, dist);
+				normals.push_back(n);
+				distances.push_back(dist);
+			}
+		};
+		rebuildNormals();
+
+		for (size_t iter = 0; iter < maxIterations; ++iter){
+			size_t minFace = 0;
+			for (size_t f = 1; f < distances.size(); ++f){
+				if (distances[f] < distances[minFace]) minFace = f;
+			}
+
+			const Vector3 n = normals[minFace];
+			const Vector3 p = MinkowskiSupport(a, b, n);
+			const float supportDist = DotProduct(n, p);
+
+			if (supportDist - distances[minFace] <= tolerance){
+				normal = n;
+				depth  = distances[minFace];
+				return true;
+			}
+
+			// Remove every face the new point can see and stitch the horizon to it.
+			std::vector<std::pair<uint32_t, uint32_t>> horizon;
+			std::vector<uint32_t> kept;
+			for (size_t f = 0; f < faces.size() / 3; ++f){
+				if (DotProduct(normals[f], p - polytope[faces[f * 3]]) > 0.0f){
+					for (size_t e = 0; e < 3; ++e){
+						const std::pair<uint32_t, uint32_t> edge(faces[f * 3 + e], faces[f * 3 + (e + 1) % 3]);
+						bool shared = false;
+						for (size_t h = 0; h < horizon.size(); ++h){
+							if (horizon[h].first == edge.second && horizon[h].second == edge.first){
+								horizon[h] = horizon.back();
+								horizon.pop_back();
+								shared = true;
+								break;
+							}
+						}
+						if (!shared) horizon.push_back(edge);
+					}
+				} else {
+					kept.insert(kept.end(), faces.begin() + f * 3, faces.begin() + f * 3 + 3);
+				}
+			}
+
+			const uint32_t newIndex = static_cast<uint32_t>(polytope.size());
+			polytope.push_back(p);
+			for (const std::pair<uint32_t, uint32_t>& edge : horizon){
+				kept.push_back(edge.first);
+				kept.push_back(edge.second);
+				kept.push_back(newIndex);
+			}
+			faces.swap(kept);
+			rebuildNormals();
+		}
+
+		// Out of iterations: report the best face found so far.
+		size_t minFace = 0;
+		for (size_t f = 1; f < distances.size(); ++f){
+			if (distances[f] < distances[minFace]) minFace = f;
+		}
+		normal = normals[minFace];
+		depth  = distances[minFace];
+		return true;
+	}
+
+	template<typename ShapeA, typename ShapeB>
+	inline bool CollideGJK(const ShapeA& a, const ShapeB& b, Vector3& normal, float& depth){
+		GJKSimplex simplex;
+		if (!GJKIntersect(a, b, simplex)) return false;
+		return EPAPenetration(a, b, simplex, normal, depth);
+	}
+	///
+	///	GJK/EPA end
+	///
+
+	///
+	///	Batch lane helpers
+	///
+	///	Writes SimdFloat::Width contacts starting at i; lanes outside hit are zeroed.
+	inline void StoreContactLanes(ContactSoA& out, size_t i, const SimdFloat& hit,
+								  const SimdFloat& nx, const SimdFloat& ny, const SimdFloat& nz, const SimdFloat& depth){
+		alignas(32) float hitLanes[SimdFloat::Width];
+		And(hit, nx).Store(&out.normalX[i]);
+		And(hit, ny).Store(&out.normalY[i]);
+		And(hit, nz).Store(&out.normalZ[i]);
+		And(hit, depth).Store(&out.depth[i]);
+
+		And(hit, SimdFloat(1.0f)).StoreAligned(hitLanes);
+		for (size_t lane = 0; lane < SimdFloat::Width; ++lane){
+			out.hit[i + lane] = (hitLanes[lane] != 0.0f) ? 1 : 0;
+		}
+	}
+
+	///	Lane twin of ContactPointPoint for d = pb - pa and radii = ra + rb.
+	inline void StoreContactPointPointLanes(ContactSoA& out, size_t i, const SimdFloat& dx, const SimdFloat& dy,
+											const SimdFloat& dz, const SimdFloat& radii){
+		const SimdFloat zero = SimdFloat::Zero();
+		const SimdFloat distSq = MulAdd(dx, dx, MulAdd(dy, dy, dz * dz));
+		const SimdFloat dist = Sqrt(distSq);
+		const SimdFloat hit = CmpLe(distSq, radii * radii);
+
+		// Coincident points fall back to +Y, like the scalar path.
+		const SimdFloat separated = CmpGt(dist, SimdFloat(EPSILON));
+		const SimdFloat inv = SimdFloat(1.0f) / Select(separated, dist, SimdFloat(1.0f));
+		const SimdFloat nx = Select(separated, dx * inv, zero);
+		const SimdFloat ny = Select(separated, dy * inv, SimdFloat(1.0f));
+		const SimdFloat nz = Select(separated, dz * inv, zero);
+		StoreContactLanes(out, i, hit, nx, ny, nz, radii - dist);
+	}
+
+	inline SimdFloat Clamp01(const SimdFloat& x){
+		return Min(Max(x, SimdFloat::Zero()), SimdFloat(1.0f));
+	}
+
+	///	Lane twin of ClosestPointsSegmentSegment: every case is evaluated and
+	///	selected per lane, with degenerate denominators replaced by 1.
+	inline void ClosestPointsSegmentSegmentLanes(const SimdFloat (&p1)[3], const SimdFloat (&q1)[3],
+												 const SimdFloat (&p2)[3], const SimdFloat (&q2)[3],
+												 SimdFloat (&c1)[3], SimdFloat (&c2)[3]){
+		const SimdFloat zero = SimdFloat::Zero();
+		const SimdFloat one(1.0f);
+		const SimdFloat eps(EPSILON);
+
+		SimdFloat d1[3], d2[3], r[3];
+		for (size_t k = 0; k < 3; ++k){
+			d1[k] = q1[k] - p1[k];
+			d2[k] = q2[k] - p2[k];
+			r[k]  = p1[k] - p2[k];
+		}
+		const SimdFloat a = MulAdd(d1[0], d1[0], MulAdd(d1[1], d1[1], d1[2] * d1[2]));
+		const SimdFloat e = MulAdd(d2[0], d2[0], MulAdd(d2[1], d2[1], d2[2] * d2[2]));
+		const SimdFloat f = MulAdd(d2[0], r[0], MulAdd(d2[1], r[1], d2[2] * r[2]));
+		const SimdFloat c = MulAdd(d1[0], r[0], MulAdd(d1[1], r[1], d1[2] * r[2]));
+		const SimdFloat b = MulAdd(d1[0], d2[0], MulAdd(d1[1], d2[1], d1[2] * d2[2]));
+
+		const SimdFloat pointA = CmpLe(a, eps);
+		const SimdFloat pointB = CmpLe(e, eps);
+		const SimdFloat invA = one / Select(pointA, one, a);
+		const SimdFloat invE = one / Select(pointB, one, e);
+
+		// Both segments proper: unclamped s, then t, then re-clamp s against the t edge.
+		const SimdFloat denom = a * e - b * b;
+		const SimdFloat skew = CmpGt(Abs(denom), zero);
+		const SimdFloat sLine = And(skew, Clamp01((b * f - c * e) / Select(skew, denom, one)));
+		const SimdFloat tLine = MulAdd(b, sLine, f) * invE;
+		const SimdFloat sEdge0 = Clamp01(-c * invA);
+		const SimdFloat sEdge1 = Clamp01((b - c) * invA);
+		const SimdFloat sBoth = Select(CmpLt(tLine, zero), sEdge0, Select(CmpGt(tLine, one), sEdge1, sLine));
+
+		const SimdFloat s = AndNot(pointA, Select(pointB, sEdge0, sBoth));
+		const SimdFloat t = AndNot(pointB, Select(pointA, Clamp01(f * invE), Clamp01(tLine)));
+
+		for (size_t k = 0; k < 3; ++k){
+			c1[k] = MulAdd(d1[k], s, p1[k]);
+			c2[k] = MulAdd(d2[k], t, p2[k]);
+		}
+	}
+	///
+	///	Batch lane helpers end
+	///
+
+	///
+	///	Batch entry points over candidate pairs
+	///
+	///	Full SimdFloat blocks of pairs run in lanes; each chunk's tail uses the
+	///	scalar routines, which remain the reference.
+	///
+	///	Spheres come in SoA; pair i tests spheres pairA[i] and pairB[i].
+	inline void CollideSpheresBatch(const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+									const uint32_t* pairA, const uint32_t* pairB, size_t count,
+									ContactSoA& out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(CollideSpheresBatch);
+		out.Resize(count);
+
+		ParallelFor(count, 4096, [&](size_t begin, size_t end, size_t){
+			size_t i = begin;
+			for (; i + SimdFloat::Width <= end; i += SimdFloat::Width){
+				const SimdFloat dx = SimdFloat::Gather(centerX, pairB + i) - SimdFloat::Gather(centerX, pairA + i);
+				const SimdFloat dy = SimdFloat::Gather(centerY, pairB + i) - SimdFloat::Gather(centerY, pairA + i);
+				const SimdFloat dz = SimdFloat::Gather(centerZ, pairB + i) - SimdFloat::Gather(centerZ, pairA + i);
+				const SimdFloat radii = SimdFloat::Gather(radius, pairA + i) + SimdFloat::Gather(radius, pairB + i);
+				StoreContactPointPointLanes(out, i, dx, dy, dz, radii);
+			}
+
+			for (; i < end; ++i){
+				const Vector3 ca(centerX[pairA[i]], centerY[pairA[i]], centerZ[pairA[i]]);
+				const Vector3 cb(centerX[pairB[i]], centerY[pairB[i]], centerZ[pairB[i]]);
+				Vector3 normal(0.0f, 0.0f, 0.0f);
+				float depth = 0.0f;
+				const bool isHit = ContactPointPoint(ca, radius[pairA[i]], cb, radius[pairB[i]], normal, depth);
+				out.Set(i, isHit, normal, depth);
+			}
+		}, threadCount);
+	}
+
+	inline void CollideCapsulesBatch(const Capsule* capsules, const uint32_t* pairA, const uint32_t* pairB, size_t count,
+									 ContactSoA& out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(CollideCapsulesBatch);
+		out.Resize(count);
+
+		ParallelFor(count, 1024, [&](size_t begin, size_t end, size_t){
+			size_t i = begin;
+			for (; i + SimdFloat::Width <= end; i += SimdFloat::Width){
+				// Transpose the AoS capsules: end points of A and B, then both radii.
+				alignas(32) float e[14][SimdFloat::Width];
+				for (size_t lane = 0; lane < SimdFloat::Width; ++lane){
+					const Capsule& ca = capsules[pairA[i + lane]];
+					const Capsule& cb = capsules[pairB[i + lane]];
+					const Vector3* ends[4] = { &ca.a, &ca.b, &cb.a, &cb.b };
+					for (size_t p = 0; p < 4; ++p){
+						e[3 * p + 0][lane] = getXComponent(*ends[p]);
+						e[3 * p + 1][lane] = getYComponent(*ends[p]);
+						e[3 * p + 2][lane] = getZComponent(*ends[p]);
+					}
+					e[12][lane] = ca.radius;
+					e[13][lane] = cb.radius;
+				}
+
+				SimdFloat p1[3], q1[3], p2[3], q2[3];
+				for (size_t k = 0; k < 3; ++k){
+					p1[k] = SimdFloat::LoadAligned(e[0 + k]);
+					q1[k] = SimdFloat::LoadAligned(e[3 + k]);
+					p2[k] = SimdFloat::LoadAligned(e[6 + k]);
+					q2[k] = SimdFloat::LoadAligned(e[9 + k]);
+				}
+
+				SimdFloat c1[3], c2[3];
+				ClosestPointsSegmentSegmentLanes(p1, q1, p2, q2, c1, c2);
+				const SimdFloat radii = SimdFloat::LoadAligned(e[12]) + SimdFloat::LoadAligned(e[13]);
+				StoreContactPointPointLanes(out, i, c2[0] - c1[0], c2[1] - c1[1], c2[2] - c1[2], radii);
+			}
+
+			for (; i < end; ++i){
+				Vector3 normal(0.0f, 0.0f, 0.0f);
+				float depth = 0.0f;
+				const bool isHit = CollideCapsuleCapsule(capsules[pairA[i]], capsules[pairB[i]], normal, depth);
+				out.Set(i, isHit, normal, depth);
+			}
+		}, threadCount);
+	}
+
+	///	The 15 SAT axes run in a fixed order for every lane; a lane is a hit
+	///	when no valid axis separates it, with the least overlap kept as in
+	///	CollideOBBOBB.
+	inline void CollideOBBsBatch(const OBB* boxes, const uint32_t* pairA, const uint32_t* pairB, size_t count,
+								 ContactSoA& out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(CollideOBBsBatch);
+		out.Resize(count);
+
+		ParallelFor(count, 512, [&](size_t begin, size_t end, size_t){
+			const SimdFloat zero = SimdFloat::Zero();
+			const SimdFloat one(1.0f);
+			const SimdFloat eps(EPSILON);
+			const int allLanes = (1 << SimdFloat::Width) - 1;
+
+			size_t i = begin;
+			for (; i + SimdFloat::Width <= end; i += SimdFloat::Width){
+				// Transpose the AoS boxes: axes of A and B, half extents, centre offset.
+				alignas(32) float e[27][SimdFloat::Width];
+				for (size_t lane = 0; lane < SimdFloat::Width; ++lane){
+					const OBB& ba = boxes[pairA[i + lane]];
+					const OBB& bb = boxes[pairB[i + lane]];
+					for (size_t col = 0; col < 3; ++col){
+						for (size_t row = 0; row < 3; ++row){
+							e[3 * col + row][lane]	   = getElement(ba.orientation, row, col);
+							e[9 + 3 * col + row][lane] = getElement(bb.orientation, row, col);
+						}
+					}
+					e[18][lane] = getXComponent(ba.halfExtents);
+					e[19][lane] = getYComponent(ba.halfExtents);
+					e[20][lane] = getZComponent(ba.halfExtents);
+					e[21][lane] = getXComponent(bb.halfExtents);
+					e[22][lane] = getYComponent(bb.halfExtents);
+					e[23][lane] = getZComponent(bb.halfExtents);
+					e[24][lane] = getXComponent(bb.center) - getXComponent(ba.center);
+					e[25][lane] = getYComponent(bb.center) - getYComponent(ba.center);
+					e[26][lane] = getZComponent(bb.center) - getZComponent(ba.center);
+				}
+
+				SimdFloat axesA[3][3], axesB[3][3], halfA[3], halfB[3], d[3];
+				for (size_t j = 0; j < 3; ++j){
+					for (size_t k = 0; k < 3; ++k){
+						axesA[j][k] = SimdFloat::LoadAligned(e[3 * j + k]);
+						axesB[j][k] = SimdFloat::LoadAligned(e[9 + 3 * j + k]);
+					}
+					halfA[j] = SimdFloat::LoadAligned(e[18 + j]);
+					halfB[j] = SimdFloat::LoadAligned(e[21 + j]);
+					d[j]	 = SimdFloat::LoadAligned(e[24 + j]);
+				}
+
+				SimdFloat separated = zero;
+				SimdFloat bestOverlap(std::numeric_limits<float>::max());
+				SimdFloat bestAxis[3] = { axesA[0][0], axesA[0][1], axesA[0][2] };
+
+				// Returns true once every lane has a separating axis, so the rest can be skipped.
+				auto testAxis = [&](const SimdFloat& x, const SimdFloat& y, const SimdFloat& z) -> bool {
+					const SimdFloat lengthSq = MulAdd(x, x, MulAdd(y, y, z * z));
+					const SimdFloat valid = CmpGe(lengthSq, eps);	// parallel edges; covered by the face axes
+					const SimdFloat inv = one / Sqrt(Select(valid, lengthSq, one));
+					const SimdFloat l[3] = { x * inv, y * inv, z * inv };
+
+					SimdFloat ra = zero, rb = zero;
+					for (size_t j = 0; j < 3; ++j){
+						ra = MulAdd(halfA[j], Abs(MulAdd(axesA[j][0], l[0], MulAdd(axesA[j][1], l[1], axesA[j][2] * l[2]))), ra);
+						rb = MulAdd(halfB[j], Abs(MulAdd(axesB[j][0], l[0], MulAdd(axesB[j][1], l[1], axesB[j][2] * l[2]))), rb);
+					}
+
+					const SimdFloat dist = MulAdd(d[0], l[0], MulAdd(d[1], l[1], d[2] * l[2]));
+					const SimdFloat overlap = ra + rb - Abs(dist);
+					separated = Or(separated, And(valid, CmpLt(overlap, zero)));
+
+					const SimdFloat better = And(valid, CmpLt(overlap, bestOverlap));
+					const SimdFloat flip = CmpLt(dist, zero);
+					bestOverlap = Select(better, overlap, bestOverlap);
+					for (size_t k = 0; k < 3; ++k) bestAxis[k] = Select(better, Select(flip, -l[k], l[k]), bestAxis[k]);
+					return MoveMask(separated) == allLanes;
+				};
+
+				bool done = false;
+				for (size_t j = 0; j < 3 && !done; ++j) done = testAxis(axesA[j][0], axesA[j][1], axesA[j][2]);
+				for (size_t j = 0; j < 3 && !done; ++j) done = testAxis(axesB[j][0], axesB[j][1], axesB[j][2]);
+				for (size_t j = 0; j < 9 && !done; ++j){
+					const SimdFloat (&u)[3] = axesA[j / 3];
+					const SimdFloat (&v)[3] = axesB[j % 3];
+					done = testAxis(u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]);
+				}
+
+				const SimdFloat hit = AndNot(separated, SimdFloat(SimdMaskBits(true)));
+				StoreContactLanes(out, i, hit, bestAxis[0], bestAxis[1], bestAxis[2], bestOverlap);
+			}
+
+			for (; i < end; ++i){
+				Vector3 normal(0.0f, 0.0f, 0.0f);
+				float depth = 0.0f;
+				const bool isHit = CollideOBBOBB(boxes[pairA[i]], boxes[pairB[i]], normal, depth);
+				out.Set(i, isHit, normal, depth);
+			}
+		}, threadCount);
+	}
+	///
+	///	Batch entry points end
+	///
+};
+
+#endif // FGML_COLLISION_HPP_
\ No newline at end of file
@@ -3,6 +3,12 @@
 
 namespace FGML {
 	const float PI = 3.14'15'92'65'35f;
+	const float HALF_PI = 1.57'07'96'32'68f;
+	const float QUARTER_PI = 0.78'53'98'16'34f;
+	const float TWO_PI = 6.28'31'85'30'72f;
+
+	const float LN2 = 0.69'31'47'18'06f;
+	const float LOG2E = 1.44'26'95'04'09f;
 
 	const float EPSILON = 1E-5f;
 };
@@ -0,0 +1,432 @@
+#ifndef FGML_CURVES_HPP_
+#define FGML_CURVES_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Views.hpp"
+#include "FastMath.hpp"
+
+namespace FGML {
+	///
+	///	Definition of Curve class
+	///
+	///	Piecewise cubic through Vector3 control points. Every segment is
+	///	stored as power-basis coefficients, p(u) = ((a u + b) u + c) u + d
+	///	with u in [0, 1], so Catmull-Rom, Bezier and Hermite input all
+	///	evaluate through the same SIMD kernel. Curve parameters t run over
+	///	[0, 1] for the whole curve, each segment taking an equal share.
+	///
+	///	The arc-length table is built on the first distance query and kept
+	///	until the next Build*; concurrent readers are safe, rebuilding while
+	///	other threads read is not.
+	///
+	///	Arc-length table samples per segment. Between samples the parameter
+	///	is a cubic Hermite in distance whose end slopes are 1 / speed.
+	const size_t CURVE_ARC_SAMPLES = 32;
+
+	class Curve {
+	private:
+		static const size_t Stride = 12;	// a.xyz, b.xyz, c.xyz, d.xyz per segment
+
+		std::vector<float>		   m_coefficients;
+		size_t					   m_segmentCount;
+
+		mutable std::mutex		   m_arcMutex;
+		mutable std::atomic<bool>  m_arcReady;
+		mutable std::vector<float> m_arcLengths;	// cumulative, segmentCount * CURVE_ARC_SAMPLES + 1
+		mutable std::vector<float> m_arcSpeeds;		// |dP/du| at the same samples
+
+		inline void Reset(size_t segmentCount);
+		inline void SetBezierSegment(size_t segment, const Vector3& p0, const Vector3& p1, const Vector3& p2, const Vector3& p3);
+		inline void BuildArcTable(void) const;
+		inline const std::vector<float>& ArcLengths(void) const;
+
+		inline float SegmentSpeed(size_t segment, float u) const;
+		inline void	 EvaluateLanes(const SimdFloat& t, SimdFloat (&position)[3], SimdFloat (&derivative)[3]) const;
+
+		inline SimdFloat DistanceLanes(const float* distances, size_t lanes) const;
+
+		template<typename Params, typename Write>
+		inline void EvaluateBlocks(size_t count, Params&& params, Write&& write, bool unitTangents, size_t threadCount) const;
+	public:
+		Curve();
+		///	Copies the control data; the copy builds its own arc-length table.
+		Curve(const Curve& other);
+		Curve& operator=(const Curve& other);
+
+		///	Uniform Catmull-Rom through all count >= 2 points; the ends use
+		///	mirrored phantom points so the curve starts and ends on them.
+		inline void BuildCatmullRom(const Vector3* points, size_t count);
+		///	Cubic Bezier segments sharing end points: count = 3 * segments + 1.
+		inline void BuildBezier(const Vector3* points, size_t count);
+		///	One segment between each pair of points, with the given
+		///	derivatives (per segment) at the points.
+		inline void BuildHermite(const Vector3* points, const Vector3* tangents, size_t count);
+
+		///	Position and dP/dt at curve parameter t (clamped to [0, 1]).
+		inline Vector3 Evaluate(float t) const;
+		inline Vector3 Derivative(float t) const;
+
+		///	Positions, and optionally dP/dt, at count parameters.
+		inline void EvaluateBatch(const float* params, size_t count, Vec3ArrayView positions,
+								  size_t threadCount = 0) const;
+		inline void EvaluateBatch(const float* params, size_t count, Vec3ArrayView positions,
+								  Vec3ArrayView tangents, size_t threadCount = 0) const;
+		///	As above into SoA arrays, which skips the AoS transpose; pass
+		///	null tangent arrays for positions only.
+		inline void EvaluateBatch(const float* params, size_t count, float* x, float* y, float* z,
+								  float* tx, float* ty, float* tz, size_t threadCount = 0) const;
+
+		inline float Length(void) const;
+		///	Curve parameter at arc length distance (clamped to [0, Length()]).
+		inline float ParameterAtDistance(float distance) const;
+		///	Positions, and optionally unit tangents, at count arc lengths.
+		inline void	 EvaluateByDistanceBatch(const float* distances, size_t count, Vec3ArrayView positions,
+											 size_t threadCount = 0) const;
+		inline void	 EvaluateByDistanceBatch(const float* distances, size_t count, Vec3ArrayView positions,
+											 Vec3ArrayView tangents, size_t threadCount = 0) const;
+		inline void	 EvaluateByDistanceBatch(const float* distances, size_t count, float* x, float* y, float* z,
+											 float* tx, float* ty, float* tz, size_t threadCount = 0) const;
+
+		inline size_t SegmentCount(void) const;
+
+		~Curve() = default;
+	};
+	///
+	///	Definition of Curve class end
+	///
+
+	///
+	///	Declaration of Curve methods
+	///
+	inline Curve::Curve() : m_segmentCount(0), m_arcReady(false) {}
+
+	inline Curve::Curve(const Curve& other)
+	: m_coefficients(other.m_coefficients), m_segmentCount(other.m_segmentCount), m_arcReady(false) {}
+
+	inline Curve& Curve::operator=(const Curve& other){
+		if (this != &other){
+			this->Reset(other.m_segmentCount);
+			this->m_coefficients = other.m_coefficients;
+		}
+		return *this;
+	}
+
+	inline void Curve::Reset(size_t segmentCount){
+		this->m_segmentCount = segmentCount;
+		this->m_coefficients.assign(segmentCount * Stride, 0.0f);
+		this->m_arcLengths.clear();
+		this->m_arcSpeeds.clear();
+		this->m_arcReady.store(false, std::memory_order_release);
+	}
+
+	///	Bezier control points to power basis.
+	inline void Curve::SetBezierSegment(size_t segment, const Vector3& p0, const Vector3& p1, const Vector3& p2, const Vector3& p3){
+		float* c = &this->m_coefficients[segment * Stride];
+		const float x[4] = { getXComponent(p0), getXComponent(p1), getXComponent(p2), getXComponent(p3) };
+		const float y[4] = { getYComponent(p0), getYComponent(p1), getYComponent(p2), getYComponent(p3) };
+		const float z[4] = { getZComponent(p0), getZComponent(p1), getZComponent(p2), getZComponent(p3) };
+		const float* axis[3] = { x, y, z };
+		for (size_t k = 0; k < 3; ++k){
+			const float* p = axis[k];
+			c[0 + k] = -p[0] + 3.0f * (p[1] - p[2]) + p[3];
+			c[3 + k] = 3.0f * (p[0] - 2.0f * p[1] + p[2]);
+			c[6 + k] = 3.0f * (p[1] - p[0]);
+			c[9 + k] = p[0];
+		}
+	}
+
+	inline void Curve::BuildCatmullRom(const Vector3* points, size_t count){
+		assert(count >= 2 && "Catmull-Rom needs at least two points");
+		this->Reset(count - 1);
+		for (size_t i = 0; i + 1 < count; ++i){
+			const Vector3& p1 = points[i];
+			const Vector3& p2 = points[i + 1];
+			const Vector3  p0 = (i > 0) ? points[i - 1] : p1 * 2.0f - p2;
+			const Vector3  p3 = (i + 2 < count) ? points[i + 2] : p2 * 2.0f - p1;
+			this->SetBezierSegment(i, p1, p1 + (p2 - p0) / 6.0f, p2 - (p3 - p1) / 6.0f, p2);
+		}
+	}
+
+	inline void Curve::BuildBezier(const Vector3* points, size_t count){
+		assert(count >= 4 && (count - 1) % 3 == 0 && "Bezier curves need 3 * segments + 1 points");
+		this->Reset((count - 1) / 3);
+		for (size_t s = 0; s < this->m_segmentCount; ++s)
+			this->SetBezierSegment(s, points[3 * s], points[3 * s + 1], points[3 * s + 2], points[3 * s + 3]);
+	}
+
+	inline void Curve::BuildHermite(const Vector3* points, const Vector3* tangents, size_t count){
+		assert(count >= 2 && "Hermite curves need at least two points");
+		this->Reset(count - 1);
+		for (size_t i = 0; i + 1 < count; ++i)
+			this->SetBezierSegment(i, points[i], points[i] + tangents[i] / 3.0f, points[i + 1] - tangents[i + 1] / 3.0f, points[i + 1]);
+	}
+
+	///	Evaluates SimdFloat::Width curve parameters; derivative is dP/dt for
+	///	the whole curve.
+	inline void Curve::EvaluateLanes(const SimdFloat& t, SimdFloat (&position)[3], SimdFloat (&derivative)[3]) const {
+		const float segments = static_cast<float>(this->m_segmentCount);
+		const SimdFloat u = Min(Max(t, SimdFloat(0.0f)), SimdFloat(1.0f)) * SimdFloat(segments);
+		const SimdFloat segment = Min(Floor(u), SimdFloat(segments - 1.0f));
+		const SimdFloat local = u - segment;
+
+		alignas(32) float index[SimdFloat::Width];
+		segment.StoreAligned(index);
+		const float* base = this->m_coefficients.data();
+		SimdFloat coefficient[Stride];
+
+		// Sorted or clustered parameters usually share a segment: broadcast.
+		const int all = (1 << SimdFloat::Width) - 1;
+		if (MoveMask(CmpEq(segment, SimdFloat(index[0]))) == all){
+			const float* c = base + static_cast<size_t>(index[0]) * Stride;
+			for (size_t k = 0; k < Stride; ++k) coefficient[k] = SimdFloat(c[k]);
+		}
+		else {
+			alignas(32) uint32_t offsets[SimdFloat::Width];
+			for (size_t l = 0; l < SimdFloat::Width; ++l) offsets[l] = static_cast<uint32_t>(index[l]) * Stride;
+			for (size_t k = 0; k < Stride; ++k) coefficient[k] = SimdFloat::Gather(base + k, offsets);
+		}
+
+		for (size_t k = 0; k < 3; ++k){
+			const SimdFloat& a = coefficient[k];
+			const SimdFloat& b = coefficient[3 + k];
+			const SimdFloat& c = coefficient[6 + k];
+			position[k] = MulAdd(MulAdd(MulAdd(a, local, b), local, c), local, coefficient[9 + k]);
+			derivative[k] = MulAdd(MulAdd(a * SimdFloat(3.0f), local, b * SimdFloat(2.0f)), local, c) * SimdFloat(segments);
+		}
+	}
+
+	inline Vector3 Curve::Evaluate(float t) const {
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		const float segments = static_cast<float>(this->m_segmentCount);
+		const float u = MIN(MAX(t, 0.0f), 1.0f) * segments;
+		const float segment = MIN(std::floor(u), segments - 1.0f);
+		const float local = u - segment;
+		const float* c = &this->m_coefficients[static_cast<size_t>(segment) * Stride];
+		return Vector3(((c[0] * local + c[3]) * local + c[6]) * local + c[9],
+					   ((c[1] * local + c[4]) * local + c[7]) * local + c[10],
+					   ((c[2] * local + c[5]) * local + c[8]) * local + c[11]);
+	}
+
+	inline Vector3 Curve::Derivative(float t) const {
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		const float segments = static_cast<float>(this->m_segmentCount);
+		const float u = MIN(MAX(t, 0.0f), 1.0f) * segments;
+		const float segment = MIN(std::floor(u), segments - 1.0f);
+		const float local = u - segment;
+		const float* c = &this->m_coefficients[static_cast<size_t>(segment) * Stride];
+		return Vector3((3.0f * c[0] * local + 2.0f * c[3]) * local + c[6],
+					   (3.0f * c[1] * local + 2.0f * c[4]) * local + c[7],
+					   (3.0f * c[2] * local + 2.0f * c[5]) * local + c[8]) * segments;
+	}
+
+	///	Transposes a block of SoA results into a Vector3 view.
+	inline void StoreCurveLanes(const SimdFloat (&v)[3], Vec3ArrayView out, size_t first, size_t lanes){
+		alignas(32) float e[3][SimdFloat::Width];
+		for (size_t k = 0; k < 3; ++k) v[k].StoreAligned(e[k]);
+		for (size_t l = 0; l < lanes; ++l){
+			out.X(first + l) = e[0][l];
+			out.Y(first + l) = e[1][l];
+			out.Z(first + l) = e[2][l];
+		}
+	}
+
+	///	Runs params(first, lanes) -> SimdFloat of curve parameters over
+	///	blocks and hands the results to write(first, lanes, position, derivative).
+	template<typename Params, typename Write>
+	inline void Curve::EvaluateBlocks(size_t count, Params&& params, Write&& write, bool unitTangents, size_t threadCount) const {
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		ForEachSimdBlock(count, threadCount, [&](size_t i, size_t lanes){
+			SimdFloat p[3], d[3];
+			this->EvaluateLanes(params(i, lanes), p, d);
+			if (unitTangents){
+				const SimdFloat length = Sqrt(MulAdd(d[0], d[0], MulAdd(d[1], d[1], d[2] * d[2])));
+				const SimdFloat inv = Select(CmpGt(length, SimdFloat(0.0f)), SimdFloat(1.0f) / length, SimdFloat(0.0f));
+				for (size_t k = 0; k < 3; ++k) d[k] *= inv;
+			}
+			write(i, lanes, p, d);
+		});
+	}
+
+	inline void Curve::EvaluateBatch(const float* params, size_t count, Vec3ArrayView positions, size_t threadCount) const {
+		FGML_SCOPED_TIMER(CurveEvaluateBatch);
+		assert(positions.size() >= count && "Mismatched batch sizes!");
+		this->EvaluateBlocks(count, [&](size_t i, size_t lanes){ return LoadLanes(params + i, lanes); },
+							 [&](size_t i, size_t lanes, const SimdFloat (&p)[3], const SimdFloat (&)[3]){
+								 StoreCurveLanes(p, positions, i, lanes);
+							 }, false, threadCount);
+	}
+
+	inline void Curve::EvaluateBatch(const float* params, size_t count, Vec3ArrayView positions,
+									 Vec3ArrayView tangents, size_t threadCount) const {
+		FGML_SCOPED_TIMER(CurveEvaluateBatch);
+		assert(positions.size() >= count && tangents.size() >= count && "Mismatched batch sizes!");
+		this->EvaluateBlocks(count, [&](size_t i, size_t lanes){ return LoadLanes(params + i, lanes); },
+							 [&](size_t i, size_t lanes, const SimdFloat (&p)[3], const SimdFloat (&d)[3]){
+								 StoreCurveLanes(p, positions, i, lanes);
+								 StoreCurveLanes(d, tangents, i, lanes);
+							 }, false, threadCount);
+	}
+
+	inline void Curve::EvaluateBatch(const float* params, size_t count, float* x, float* y, float* z,
+									 float* tx, float* ty, float* tz, size_t threadCount) const {
+		FGML_SCOPED_TIMER(CurveEvaluateBatch);
+		this->EvaluateBlocks(count, [&](size_t i, size_t lanes){ return LoadLanes(params + i, lanes); },
+							 [&](size_t i, size_t lanes, const SimdFloat (&p)[3], const SimdFloat (&d)[3]){
+								 StoreLanes(p[0], x + i, lanes);
+								 StoreLanes(p[1], y + i, lanes);
+								 StoreLanes(p[2], z + i, lanes);
+								 if (tx == nullptr) return;
+								 StoreLanes(d[0], tx + i, lanes);
+								 StoreLanes(d[1], ty + i, lanes);
+								 StoreLanes(d[2], tz + i, lanes);
+							 }, false, threadCount);
+	}
+
+	inline float Curve::SegmentSpeed(size_t segment, float u) const {
+		const float* c = &this->m_coefficients[segment * Stride];
+		const float dx = (3.0f * c[0] * u + 2.0f * c[3]) * u + c[6];
+		const float dy = (3.0f * c[1] * u + 2.0f * c[4]) * u + c[7];
+		const float dz = (3.0f * c[2] * u + 2.0f * c[5]) * u + c[8];
+		return std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	///	Five-point Gauss-Legendre per table interval; exact for the
+	///	polynomial part of the speed up to degree 9.
+	inline void Curve::BuildArcTable(void) const {
+		FGML_SCOPED_TIMER(CurveArcTable);
+		static const float nodes[5]	  = { -0.9061798459f, -0.5384693101f, 0.0f, 0.5384693101f, 0.9061798459f };
+		static const float weights[5] = { 0.2369268851f, 0.4786286705f, 0.5688888889f, 0.4786286705f, 0.2369268851f };
+		const float step = 1.0f / static_cast<float>(CURVE_ARC_SAMPLES);
+
+		// An unbuilt curve gets a zero-length table instead of reading segment -1.
+		if (this->m_segmentCount == 0){
+			this->m_arcLengths.assign(1, 0.0f);
+			this->m_arcSpeeds.assign(1, 0.0f);
+			return;
+		}
+
+		this->m_arcLengths.resize(this->m_segmentCount * CURVE_ARC_SAMPLES + 1);
+		this->m_arcSpeeds.resize(this->m_arcLengths.size());
+		this->m_arcLengths[0] = 0.0f;
+		double total = 0.0;
+		for (size_t s = 0; s < this->m_segmentCount; ++s){
+			for (size_t k = 0; k < CURVE_ARC_SAMPLES; ++k){
+				this->m_arcSpeeds[s * CURVE_ARC_SAMPLES + k] = this->SegmentSpeed(s, static_cast<float>(k) * step);
+				const float mid = (static_cast<float>(k) + 0.5f) * step;
+				float length = 0.0f;
+				for (size_t g = 0; g < 5; ++g) length += weights[g] * this->SegmentSpeed(s, mid + 0.5f * step * nodes[g]);
+				total += 0.5 * step * length;
+				this->m_arcLengths[s * CURVE_ARC_SAMPLES + k + 1] = static_cast<float>(total);
+			}
+		}
+		this->m_arcSpeeds.back() = this->SegmentSpeed(this->m_segmentCount - 1, 1.0f);
+	}
+
+	///	Double-checked: after the first call readers only see the flag.
+	inline const std::vector<float>& Curve::ArcLengths(void) const {
+		if (!this->m_arcReady.load(std::memory_order_acquire)){
+			std::lock_guard<std::mutex> lock(this->m_arcMutex);
+			if (!this->m_arcReady.load(std::memory_order_relaxed)){
+				this->BuildArcTable();
+				this->m_arcReady.store(true, std::memory_order_release);
+			}
+		}
+		return this->m_arcLengths;
+	}
+
+	inline float Curve::Length(void) const {
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		return this->ArcLengths().back();
+	}
+
+	inline float Curve::ParameterAtDistance(float distance) const {
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		const std::vector<float>& lengths = this->ArcLengths();
+		const size_t samples = lengths.size() - 1;
+		if (!(distance > 0.0f)) return 0.0f;
+		if (distance >= lengths.back()) return 1.0f;
+
+		const size_t k = static_cast<size_t>(std::upper_bound(lengths.begin(), lengths.end(), distance) - lengths.begin()) - 1;
+		const float span = lengths[k + 1] - lengths[k];
+		if (!(span > 0.0f)) return static_cast<float>(k) / static_cast<float>(samples);
+
+		// Hermite in x = fraction of the span. dt/dx = span / (speed * step),
+		// in sample units; slopes are capped so cusps fall back towards linear.
+		const float x = (distance - lengths[k]) / span;
+		const float step = 1.0f / static_cast<float>(CURVE_ARC_SAMPLES);
+		const float m0 = MIN(span / MAX(this->m_arcSpeeds[k] * step, 1E-30f), 3.0f);
+		const float m1 = MIN(span / MAX(this->m_arcSpeeds[k + 1] * step, 1E-30f), 3.0f);
+		const float x2 = x * x, x3 = x2 * x;
+		const float fraction = (x3 - 2.0f * x2 + x) * m0 + (-2.0f * x3 + 3.0f * x2) + (x3 - x2) * m1;
+		return (static_cast<float>(k) + MIN(MAX(fraction, 0.0f), 1.0f)) / static_cast<float>(samples);
+	}
+
+	inline SimdFloat Curve::DistanceLanes(const float* distances, size_t lanes) const {
+		alignas(32) float t[SimdFloat::Width] = {};
+		for (size_t l = 0; l < lanes; ++l) t[l] = this->ParameterAtDistance(distances[l]);
+		return SimdFloat::LoadAligned(t);
+	}
+
+	inline void Curve::EvaluateByDistanceBatch(const float* distances, size_t count, Vec3ArrayView positions,
+											   size_t threadCount) const {
+		FGML_SCOPED_TIMER(CurveDistanceBatch);
+		assert(positions.size() >= count && "Mismatched batch sizes!");
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		this->ArcLengths();
+		this->EvaluateBlocks(count, [&](size_t i, size_t lanes){ return this->DistanceLanes(distances + i, lanes); },
+							 [&](size_t i, size_t lanes, const SimdFloat (&p)[3], const SimdFloat (&)[3]){
+								 StoreCurveLanes(p, positions, i, lanes);
+							 }, false, threadCount);
+	}
+
+	///	Tangents are dP/ds, i.e. unit length away from cusps.
+	inline void Curve::EvaluateByDistanceBatch(const float* distances, size_t count, Vec3ArrayView positions,
+											   Vec3ArrayView tangents, size_t threadCount) const {
+		FGML_SCOPED_TIMER(CurveDistanceBatch);
+		assert(positions.size() >= count && tangents.size() >= count && "Mismatched batch sizes!");
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		this->ArcLengths();
+		this->EvaluateBlocks(count, [&](size_t i, size_t lanes){ return this->DistanceLanes(distances + i, lanes); },
+							 [&](size_t i, size_t lanes, const SimdFloat (&p)[3], const SimdFloat (&d)[3]){
+								 StoreCurveLanes(p, positions, i, lanes);
+								 StoreCurveLanes(d, tangents, i, lanes);
+							 }, true, threadCount);
+	}
+
+	inline void Curve::EvaluateByDistanceBatch(const float* distances, size_t count, float* x, float* y, float* z,
+											   float* tx, float* ty, float* tz, size_t threadCount) const {
+		FGML_SCOPED_TIMER(CurveDistanceBatch);
+		assert(this->m_segmentCount > 0 && "Curve has not been built");
+		this->ArcLengths();
+		this->EvaluateBlocks(count, [&](size_t i, size_t lanes){ return this->DistanceLanes(distances + i, lanes); },
+							 [&](size_t i, size_t lanes, const SimdFloat (&p)[3], const SimdFloat (&d)[3]){
+								 StoreLanes(p[0], x + i, lanes);
+								 StoreLanes(p[1], y + i, lanes);
+								 StoreLanes(p[2], z + i, lanes);
+								 if (tx == nullptr) return;
+								 StoreLanes(d[0], tx + i, lanes);
+								 StoreLanes(d[1], ty + i, lanes);
+								 StoreLanes(d[2], tz + i, lanes);
+							 }, tx != nullptr, threadCount);
+	}
+
+	inline size_t Curve::SegmentCount(void) const { return this->m_segmentCount; }
+	///
+	///	Declaration of Curve methods end
+	///
+};
+
+#endif // FGML_CURVES_HPP_
\ No newline at end of file
@@ -0,0 +1,290 @@
+#ifndef FGML_DECOMPOSE_HPP_
+#define FGML_DECOMPOSE_HPP_
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+
+#include "Constants.hpp"
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix3x3.hpp"
+#include "Matrix4x4.hpp"
+#include "Views.hpp"
+
+namespace FGML {
+	///
+	///	Definition of Transform
+	///
+	///	Translation, rotation and per-axis scale of an affine Matrix4x4 that
+	///	maps column vectors (translation in column 3). Compose builds
+	///	T * R * S. The rotation is a unit quaternion Vector4(x, y, z, w) with
+	///	w >= 0, so equal rotations always encode the same way. A mirrored
+	///	matrix comes back as a proper rotation with a negative z scale.
+	///
+	struct Transform {
+		Vector3 translation = Vector3(0.0f, 0.0f, 0.0f);
+		Vector4 rotation	= Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+		Vector3 scale		= Vector3(1.0f, 1.0f, 1.0f);
+	};
+
+	///	How the rotation is recovered from the upper 3x3 block.
+	///	GramSchmidt keeps the x axis exact and is the cheapest.
+	///	Polar finds the closest rotation in the Frobenius norm. It spreads
+	///	the error across all three axes, which suits sheared or drifting
+	///	matrices.
+	enum class Orthonormalization {
+		GramSchmidt,
+		Polar
+	};
+
+	const size_t DECOMPOSE_MIN_CHUNK = 2048;
+	const size_t POLAR_MAX_ITERATIONS = 16;
+	const float POLAR_TOLERANCE = 1E-6f;
+	///
+	///	Definition of Transform end
+	///
+
+	///
+	///	Decomposition internals
+	///
+	///	Kernels run on plain row-major float[3][3] blocks so the batch loops
+	///	stay free of temporaries.
+	using Block3 = float[3][3];
+
+	inline float BlockDeterminant(const Block3& a){
+		return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+			 - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+			 + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+	}
+
+	inline float BlockColumnDot(const Block3& a, size_t i, const Block3& b, size_t j){
+		return a[0][i] * b[0][j] + a[1][i] * b[1][j] + a[2][i] * b[2][j];
+	}
+
+	///	Columns of r: normalize(a0), then a1 with its a0 part removed, then
+	///	their cross product, so r is always a proper rotation.
+	inline void GramSchmidtBlock(const Block3& a, Block3& r){
+		const float inv0 = 1.0f / std::sqrt(BlockColumnDot(a, 0, a, 0));
+		for (size_t k = 0; k < 3; ++k) r[k][0] = a[k][0] * inv0;
+
+		const float along = BlockColumnDot(r, 0, a, 1);
+		for (size_t k = 0; k < 3; ++k) r[k][1] = a[k][1] - along * r[k][0];
+		const float inv1 = 1.0f / std::sqrt(BlockColumnDot(r, 1, r, 1));
+		for (size_t k = 0; k < 3; ++k) r[k][1] *= inv1;
+
+		r[0][2] = r[1][0] * r[2][1] - r[2][0] * r[1][1];
+		r[1][2] = r[2][0] * r[0][1] - r[0][0] * r[2][1];
+		r[2][2] = r[0][0] * r[1][1] - r[1][0] * r[0][1];
+	}
+
+	///	Higham's scaled Newton iteration X <- (g X + X^-T / g) / 2, which
+	///	converges quadratically to the orthogonal polar factor. a must have
+	///	a positive determinant for the result to be a proper rotation.
+	inline void PolarBlock(const Block3& a, Block3& r, size_t maxIterations, float tolerance){
+		Block3 x;
+		for (size_t i = 0; i < 3; ++i) for (size_t j = 0; j < 3; ++j) x[i][j] = a[i][j];
+
+		for (size_t iteration = 0; iteration < maxIterations; ++iteration){
+			// Cofactors: X^-T = C / det(X).
+			Block3 c;
+			float normX = 0.0f, normC = 0.0f;
+			for (size_t i = 0; i < 3; ++i){
+				const size_t i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+				for (size_t j = 0; j < 3; ++j){
+					const size_t j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+					c[i][j] = x[i1][j1] * x[i2][j2] - x[i1][j2] * x[i2][j1];
+					normX += SQR(x[i][j]);
+					normC += SQR(c[i][j]);
+				}
+			}
+			const float det = x[0][0] * c[0][0] + x[0][1] * c[0][1] + x[0][2] * c[0][2];
+			const float gamma = std::sqrt(std::sqrt(normC / normX) / std::fabs(det));
+			const float keep = 0.5f * gamma, invert = 0.5f / (gamma * det);
+
+			float change = 0.0f;
+			for (size_t i = 0; i < 3; ++i){
+				for (size_t j = 0; j < 3; ++j){
+					const float next = keep * x[i][j] + invert * c[i][j];
+					change += SQR(next - x[i][j]);
+					x[i][j] = next;
+				}
+			}
+			if (change <= SQR(tolerance)) break;
+		}
+
+		for (size_t i = 0; i < 3; ++i) for (size_t j = 0; j < 3; ++j) r[i][j] = x[i][j];
+	}
+
+	///	Shepperd's method: pivot on the largest of w, x, y, z for stability.
+	inline Vector4 BlockQuaternion(const Block3& r){
+		const float trace = r[0][0] + r[1][1] + r[2][2];
+		float x, y, z, w;
+		if (trace > 0.0f){
+			const float s = 2.0f * std::sqrt(trace + 1.0f);
+			w = 0.25f * s;
+			x = (r[2][1] - r[1][2]) / s;
+			y = (r[0][2] - r[2][0]) / s;
+			z = (r[1][0] - r[0][1]) / s;
+		} else if (r[0][0] > r[1][1] && r[0][0] > r[2][2]){
+			const float s = 2.0f * std::sqrt(1.0f + r[0][0] - r[1][1] - r[2][2]);
+			w = (r[2][1] - r[1][2]) / s;
+			x = 0.25f * s;
+			y = (r[0][1] + r[1][0]) / s;
+			z = (r[0][2] + r[2][0]) / s;
+		} else if (r[1][1] > r[2][2]){
+			const float s = 2.0f * std::sqrt(1.0f + r[1][1] - r[0][0] - r[2][2]);
+			w = (r[0][2] - r[2][0]) / s;
+			x = (r[0][1] + r[1][0]) / s;
+			y = 0.25f * s;
+			z = (r[1][2] + r[2][1]) / s;
+		} else {
+			const float s = 2.0f * std::sqrt(1.0f + r[2][2] - r[0][0] - r[1][1]);
+			w = (r[1][0] - r[0][1]) / s;
+			x = (r[0][2] + r[2][0]) / s;
+			y = (r[1][2] + r[2][1]) / s;
+			z = 0.25f * s;
+		}
+
+		const float invLength = ((w < 0.0f) ? -1.0f : 1.0f) / std::sqrt(x * x + y * y + z * z + w * w);
+		return Vector4(x * invLength, y * invLength, z * invLength, w * invLength);
+	}
+
+	///	Rotation matrix of a unit quaternion.
+	inline void QuaternionBlock(const Vector4& q, Block3& r){
+		const float x = getXComponent(q), y = getYComponent(q), z = getZComponent(q), w = getWComponent(q);
+		const float xx = x * x, yy = y * y, zz = z * z;
+		const float xy = x * y, xz = x * z, yz = y * z, wx = w * x, wy = w * y, wz = w * z;
+		r[0][0] = 1.0f - 2.0f * (yy + zz);	r[0][1] = 2.0f * (xy - wz);			r[0][2] = 2.0f * (xz + wy);
+		r[1][0] = 2.0f * (xy + wz);			r[1][1] = 1.0f - 2.0f * (xx + zz);	r[1][2] = 2.0f * (yz - wx);
+		r[2][0] = 2.0f * (xz - wy);			r[2][1] = 2.0f * (yz + wx);			r[2][2] = 1.0f - 2.0f * (xx + yy);
+	}
+
+	///	Rotation part of a; returns false when a is singular or nearly so.
+	inline bool OrthonormalizeBlock(const Block3& a, Block3& r, Orthonormalization method){
+		const float length0 = std::sqrt(BlockColumnDot(a, 0, a, 0));
+		const float length1 = std::sqrt(BlockColumnDot(a, 1, a, 1));
+		const float length2 = std::sqrt(BlockColumnDot(a, 2, a, 2));
+		const float det = BlockDeterminant(a);
+		if (std::fabs(det) <= EPSILON * length0 * length1 * length2 || length0 * length1 * length2 == 0.0f){
+			for (size_t i = 0; i < 3; ++i) for (size_t j = 0; j < 3; ++j) r[i][j] = (i == j) ? 1.0f : 0.0f;
+			return false;
+		}
+
+		if (method == Orthonormalization::GramSchmidt){
+			GramSchmidtBlock(a, r);
+			return true;
+		}
+
+		// Mirror the z axis first so the polar factor is a proper rotation.
+		Block3 proper;
+		const float flip = (det < 0.0f) ? -1.0f : 1.0f;
+		for (size_t i = 0; i < 3; ++i){
+			proper[i][0] = a[i][0];
+			proper[i][1] = a[i][1];
+			proper[i][2] = a[i][2] * flip;
+		}
+		PolarBlock(proper, r, POLAR_MAX_ITERATIONS, POLAR_TOLERANCE);
+		return true;
+	}
+
+	inline bool DecomposeInto(const Matrix4x4& mat, Transform& out, Orthonormalization method){
+		Block3 a, r;
+		for (size_t i = 0; i < 3; ++i) for (size_t j = 0; j < 3; ++j) a[i][j] = getElement(mat, i, j);
+		out.translation = Vector3(getElement(mat, 0, 3), getElement(mat, 1, 3), getElement(mat, 2, 3));
+
+		const bool valid = OrthonormalizeBlock(a, r, method);
+		out.rotation = BlockQuaternion(r);
+		// Scale is diag(R^T A): the column lengths without shear, signed
+		// so that a mirrored input keeps its handedness in scale.z.
+		out.scale = valid ? Vector3(BlockColumnDot(r, 0, a, 0), BlockColumnDot(r, 1, a, 1), BlockColumnDot(r, 2, a, 2))
+						  : Vector3(std::sqrt(BlockColumnDot(a, 0, a, 0)),
+									std::sqrt(BlockColumnDot(a, 1, a, 1)),
+									std::sqrt(BlockColumnDot(a, 2, a, 2)));
+		return valid;
+	}
+
+	inline Matrix4x4 ComposeFrom(const Transform& t){
+		Block3 r;
+		QuaternionBlock(t.rotation, r);
+		const float sx = getXComponent(t.scale), sy = getYComponent(t.scale), sz = getZComponent(t.scale);
+		return Matrix4x4( r[0][0] * sx, r[0][1] * sy, r[0][2] * sz, getXComponent(t.translation),
+						  r[1][0] * sx, r[1][1] * sy, r[1][2] * sz, getYComponent(t.translation),
+						  r[2][0] * sx, r[2][1] * sy, r[2][2] * sz, getZComponent(t.translation),
+						  0.0f,			0.0f,		  0.0f,			1.0f );
+	}
+	///
+	///	Decomposition internals end
+	///
+
+	///
+	///	Decomposition
+	///
+	///	Unit quaternion of a rotation matrix (w >= 0).
+	inline Vector4 QuaternionFromRotation(const Matrix3x3& rotation){
+		Block3 r;
+		for (size_t i = 0; i < 3; ++i) for (size_t j = 0; j < 3; ++j) r[i][j] = getElement(rotation, i, j);
+		return BlockQuaternion(r);
+	}
+
+	///	Nearest proper rotation to mat; identity when mat is singular.
+	inline Matrix3x3 Orthonormalize(const Matrix3x3& mat, Orthonormalization method = Orthonormalization::GramSchmidt){
+		Block3 a, r;
+		for (size_t i = 0; i < 3; ++i) for (size_t j = 0; j < 3; ++j) a[i][j] = getElement(mat, i, j);
+		OrthonormalizeBlock(a, r, method);
+		return Matrix3x3( r[0][0], r[0][1], r[0][2],
+						  r[1][0], r[1][1], r[1][2],
+						  r[2][0], r[2][1], r[2][2] );
+	}
+
+	///	Splits an affine matrix into translation, rotation and scale; shear
+	///	is discarded. Returns false (identity rotation, unsigned column
+	///	lengths as scale) when the 3x3 block is singular.
+	inline bool Decompose(const Matrix4x4& mat, Transform& out, Orthonormalization method = Orthonormalization::GramSchmidt){
+		return DecomposeInto(mat, out, method);
+	}
+
+	inline Matrix4x4 Compose(const Transform& transform){
+		return ComposeFrom(transform);
+	}
+
+	///	Decomposes every matrix of the view in parallel; returns how many
+	///	were singular. The view may wrap an external buffer in either layout.
+	inline size_t DecomposeBatch(ConstMat4ArrayView mats, Transform* out,
+								 Orthonormalization method = Orthonormalization::GramSchmidt, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(DecomposeBatch);
+		std::atomic<size_t> singular(0);
+		ParallelFor(mats.size(), DECOMPOSE_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			size_t local = 0;
+			for (size_t i = begin; i < end; ++i)
+				if (!DecomposeInto(mats.Get(i), out[i], method)) ++local;
+			if (local != 0) singular.fetch_add(local, std::memory_order_relaxed);
+		}, threadCount);
+		return singular.load(std::memory_order_relaxed);
+	}
+
+	inline size_t DecomposeBatch(const Matrix4x4* mats, size_t count, Transform* out,
+								 Orthonormalization method = Orthonormalization::GramSchmidt, size_t threadCount = 0){
+		return DecomposeBatch(ConstMat4ArrayView(mats, count), out, method, threadCount);
+	}
+
+	///	Composes transforms into the first out.size() matrices of the view.
+	inline void ComposeBatch(const Transform* transforms, Mat4ArrayView out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(ComposeBatch);
+		ParallelFor(out.size(), DECOMPOSE_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i) out.Set(i, ComposeFrom(transforms[i]));
+		}, threadCount);
+	}
+
+	inline void ComposeBatch(const Transform* transforms, size_t count, Matrix4x4* out, size_t threadCount = 0){
+		ComposeBatch(transforms, Mat4ArrayView(out, count), threadCount);
+	}
+	///
+	///	Decomposition end
+	///
+};
+
+#endif // FGML_DECOMPOSE_HPP_
\ No newline at end of file
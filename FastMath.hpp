@@ -0,0 +1,444 @@
+#ifndef FGML_FASTMATH_HPP_
+#define FGML_FASTMATH_HPP_
+
+#include <cstddef>
+#include <limits>
+
+#include "Constants.hpp"
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix3x3.hpp"
+#include "Matrix4x4.hpp"
+#include "Views.hpp"
+
+namespace FGML {
+	///
+	///	Polynomial approximations
+	///
+	///	Every function is written once for T = float or SimdFloat, so scalar
+	///	and batch callers get bit-identical results. Coefficients are the
+	///	single-precision Cephes minimax sets. Error bounds below were measured
+	///	against double-precision libm over 10^7 uniformly spaced inputs.
+	///
+
+	///	Sine and cosine of x.
+	///	|x| <= 8192: absolute error <= 1.0e-7 (under 1 ulp at 1.0).
+	///	Accuracy degrades beyond that as the pi/2 reduction loses bits; the
+	///	SSE2 floor also requires |x| < 2^31.
+	template<typename T>
+	inline void FastSinCos(const T& x, T& sine, T& cosine){
+		// Nearest multiple of pi/2, removed in three parts (Cody-Waite) so
+		// the reduced argument r in [-pi/4, pi/4] keeps its low bits.
+		const T quadrant = Floor(MulAdd(x, T(2.0f / PI), T(0.5f)));
+		T r = MulAdd(quadrant, T(-1.5703125f), x);
+		r = MulAdd(quadrant, T(-4.837512969970703125e-4f), r);
+		r = MulAdd(quadrant, T(-7.549789954891882e-8f), r);
+
+		const T r2 = r * r;
+		const T s = MulAdd(MulAdd(MulAdd(T(-1.9515295891e-4f), r2, T(8.3321608736e-3f)), r2, T(-1.6666654611e-1f)),
+						   r2 * r, r);
+		const T c = MulAdd(MulAdd(MulAdd(T(2.443315711809948e-5f), r2, T(-1.388731625493765e-3f)), r2, T(4.166664568298827e-2f)),
+						   r2 * r2, MulAdd(r2, T(-0.5f), T(1.0f)));
+
+		// Quadrant mod 4 picks which polynomial feeds each output and its sign.
+		const T q = quadrant - T(4.0f) * Floor(quadrant * T(0.25f));
+		const T swap = Or(CmpEq(q, T(1.0f)), CmpEq(q, T(3.0f)));
+		const T sinNegative = CmpGe(q, T(2.0f));
+		const T cosNegative = Or(CmpEq(q, T(1.0f)), CmpEq(q, T(2.0f)));
+
+		const T sinAbs = Select(swap, c, s);
+		const T cosAbs = Select(swap, s, c);
+		sine = Select(sinNegative, -sinAbs, sinAbs);
+		cosine = Select(cosNegative, -cosAbs, cosAbs);
+	}
+
+	template<typename T>
+	inline T FastSin(const T& x){
+		T s, c;
+		FastSinCos(x, s, c);
+		return s;
+	}
+
+	template<typename T>
+	inline T FastCos(const T& x){
+		T s, c;
+		FastSinCos(x, s, c);
+		return c;
+	}
+
+	///	atan2(y, x) in [-pi, pi] for finite inputs; atan2(0, 0) = 0.
+	///	Absolute error <= 2.8e-7. The sign of a zero y is not honoured.
+	template<typename T>
+	inline T FastAtan2(const T& y, const T& x){
+		const T ax = Abs(x), ay = Abs(y);
+		const T hi = Max(ax, ay), lo = Min(ax, ay);
+		const T t = Select(CmpGt(hi, T(0.0f)), lo / hi, T(0.0f));
+
+		// atan on [0, 1], reduced to |z| <= tan(pi/8) around pi/4.
+		const T shifted = CmpGt(t, T(0.41421356f));
+		const T z = Select(shifted, (t - T(1.0f)) / (t + T(1.0f)), t);
+		const T z2 = z * z;
+		T angle = MulAdd(MulAdd(MulAdd(MulAdd(T(8.05374449538e-2f), z2, T(-1.38776856032e-1f)), z2, T(1.99777106478e-1f)),
+								z2, T(-3.33329491539e-1f)), z2 * z, z);
+		angle = angle + And(shifted, T(QUARTER_PI));
+
+		// Undo the octant folding.
+		angle = Select(CmpGt(ay, ax), T(HALF_PI) - angle, angle);
+		angle = Select(CmpLt(x, T(0.0f)), T(PI) - angle, angle);
+		return Select(CmpLt(y, T(0.0f)), -angle, angle);
+	}
+
+	///	acos(x) in [0, pi]; x is clamped to [-1, 1] so dot products that
+	///	drift past unit length stay finite. Absolute error <= 3.1e-7.
+	template<typename T>
+	inline T FastAcos(const T& x){
+		const T ax = Min(Abs(x), T(1.0f));
+		// Near |x| = 1 use acos(a) = 2 asin(sqrt((1 - a) / 2)) to avoid
+		// cancellation; otherwise acos(a) = pi/2 - asin(a).
+		const T nearOne = CmpGt(ax, T(0.5f));
+		const T z = Select(nearOne, (T(1.0f) - ax) * T(0.5f), ax * ax);
+		const T s = Select(nearOne, Sqrt(z), ax);
+
+		const T poly = MulAdd(MulAdd(MulAdd(MulAdd(T(4.2163199048e-2f), z, T(2.4181311049e-2f)), z, T(4.5470025998e-2f)),
+								z, T(7.4953002686e-2f)), z, T(1.6666752422e-1f));
+		const T asinS = MulAdd(s * z, poly, s);
+
+		const T acosAbs = Select(nearOne, asinS + asinS, T(HALF_PI) - asinS);
+		return Select(CmpLt(x, T(0.0f)), T(PI) - acosAbs, acosAbs);
+	}
+
+	///	e^x with x clamped to [-87, 88], so the result is always a finite,
+	///	normal float. Relative error <= 1.2e-7.
+	template<typename T>
+	inline T FastExp(const T& x){
+		const T cx = Min(Max(x, T(-87.0f)), T(88.0f));
+		// x = n ln2 + r with |r| <= ln2 / 2; ln2 split in two for exactness.
+		const T n = Floor(MulAdd(cx, T(LOG2E), T(0.5f)));
+		T r = MulAdd(n, T(-0.693359375f), cx);
+		r = MulAdd(n, T(2.12194440e-4f), r);
+
+		const T poly = MulAdd(MulAdd(MulAdd(MulAdd(MulAdd(T(1.9875691500e-4f), r, T(1.3981999507e-3f)), r, T(8.3334519073e-3f)),
+								r, T(4.1665795894e-2f)), r, T(1.6666665459e-1f)), r, T(5.0000001201e-1f));
+		const T expR = MulAdd(poly, r * r, r + T(1.0f));
+		return expR * Exp2Int(n);
+	}
+
+	///	Natural log for positive normal x; log(0) = -inf and log(x < 0) = NaN.
+	///	Absolute error <= 4e-8 for x in [0.5, 2], relative error <= 8e-8
+	///	elsewhere.
+	template<typename T>
+	inline T FastLog(const T& x){
+		T e;
+		T m = SplitExponent(x, e);
+
+		// Re-centre the mantissa on [sqrt(0.5), sqrt(2)) and take m - 1.
+		const T low = CmpLt(m, T(0.70710678f));
+		e = e - And(low, T(1.0f));
+		m = Select(low, m + m, m) - T(1.0f);
+
+		const T z = m * m;
+		T poly = MulAdd(T(7.0376836292e-2f), m, T(-1.1514610310e-1f));
+		poly = MulAdd(poly, m, T(1.1676998740e-1f));
+		poly = MulAdd(poly, m, T(-1.2420140846e-1f));
+		poly = MulAdd(poly, m, T(1.4249322787e-1f));
+		poly = MulAdd(poly, m, T(-1.6668057665e-1f));
+		poly = MulAdd(poly, m, T(2.0000714765e-1f));
+		poly = MulAdd(poly, m, T(-2.4999993993e-1f));
+		poly = MulAdd(poly, m, T(3.3333331174e-1f));
+
+		T y = m * z * poly;
+		y = MulAdd(e, T(-2.12194440e-4f), y);
+		y = MulAdd(z, T(-0.5f), y);
+		const T result = MulAdd(e, T(0.693359375f), m + y);
+
+		const T negInf(-std::numeric_limits<float>::infinity());
+		const T nan(std::numeric_limits<float>::quiet_NaN());
+		return Select(CmpLt(x, T(0.0f)), nan, Select(CmpEq(x, T(0.0f)), negInf, result));
+	}
+	///
+	///	Polynomial approximations end
+	///
+
+	///
+	///	Rotation builders
+	///
+	///	Euler angles are applied as R = Ry(yaw) * Rx(pitch) * Rz(roll), so a
+	///	column vector is rolled first, then pitched, then yawed. Axis-angle
+	///	inputs expect unit axes. Quaternions are Vector4(x, y, z, w).
+	///
+	template<typename T>
+	inline void EulerToRotation(const T& yaw, const T& pitch, const T& roll, T (&r)[9]){
+		T sy, cy, sp, cp, sr, cr;
+		FastSinCos(yaw, sy, cy);
+		FastSinCos(pitch, sp, cp);
+		FastSinCos(roll, sr, cr);
+
+		const T sysp = sy * sp, cysp = cy * sp;
+		r[0] = MulAdd(sysp, sr, cy * cr);	r[1] = MulAdd(sysp, cr, -(cy * sr));	r[2] = sy * cp;
+		r[3] = cp * sr;						r[4] = cp * cr;						r[5] = -sp;
+		r[6] = MulAdd(cysp, sr, -(sy * cr));	r[7] = MulAdd(cysp, cr, sy * sr);		r[8] = cy * cp;
+	}
+
+	template<typename T>
+	inline void EulerToQuaternion(const T& yaw, const T& pitch, const T& roll, T (&q)[4]){
+		T sy, cy, sp, cp, sr, cr;
+		FastSinCos(yaw * T(0.5f), sy, cy);
+		FastSinCos(pitch * T(0.5f), sp, cp);
+		FastSinCos(roll * T(0.5f), sr, cr);
+
+		const T cycp = cy * cp, sysp = sy * sp, cysp = cy * sp, sycp = sy * cp;
+		q[0] = MulAdd(cysp, cr, sycp * sr);
+		q[1] = MulAdd(sycp, cr, -(cysp * sr));
+		q[2] = MulAdd(cycp, sr, -(sysp * cr));
+		q[3] = MulAdd(cycp, cr, sysp * sr);
+	}
+
+	///	Rodrigues: R = cI + (1 - c) a a^T + s [a]x.
+	template<typename T>
+	inline void AxisAngleToRotation(const T& ax, const T& ay, const T& az, const T& angle, T (&r)[9]){
+		T s, c;
+		FastSinCos(angle, s, c);
+		const T t = T(1.0f) - c;
+
+		const T txy = t * ax * ay, txz = t * ax * az, tyz = t * ay * az;
+		const T sx = s * ax, sy = s * ay, sz = s * az;
+		r[0] = MulAdd(t * ax, ax, c);	r[1] = txy - sz;				r[2] = txz + sy;
+		r[3] = txy + sz;				r[4] = MulAdd(t * ay, ay, c);	r[5] = tyz - sx;
+		r[6] = txz - sy;				r[7] = tyz + sx;				r[8] = MulAdd(t * az, az, c);
+	}
+
+	template<typename T>
+	inline void AxisAngleToQuaternion(const T& ax, const T& ay, const T& az, const T& angle, T (&q)[4]){
+		T s, c;
+		FastSinCos(angle * T(0.5f), s, c);
+		q[0] = ax * s;
+		q[1] = ay * s;
+		q[2] = az * s;
+		q[3] = c;
+	}
+
+	inline Matrix3x3 RotationFromEuler(float yaw, float pitch, float roll){
+		float r[9];
+		EulerToRotation(yaw, pitch, roll, r);
+		return Matrix3x3(r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8]);
+	}
+
+	inline Vector4 QuaternionFromEuler(float yaw, float pitch, float roll){
+		float q[4];
+		EulerToQuaternion(yaw, pitch, roll, q);
+		return Vector4(q[0], q[1], q[2], q[3]);
+	}
+
+	inline Matrix3x3 RotationFromAxisAngle(const Vector3& axis, float angle){
+		float r[9];
+		AxisAngleToRotation(getXComponent(axis), getYComponent(axis), getZComponent(axis), angle, r);
+		return Matrix3x3(r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7], r[8]);
+	}
+
+	inline Vector4 QuaternionFromAxisAngle(const Vector3& axis, float angle){
+		float q[4];
+		AxisAngleToQuaternion(getXComponent(axis), getYComponent(axis), getZComponent(axis), angle, q);
+		return Vector4(q[0], q[1], q[2], q[3]);
+	}
+	///
+	///	Rotation builders end
+	///
+
+	///
+	///	Batch internals
+	///
+	///	Elements per worker chunk for the batch entry points.
+	const size_t FASTMATH_MIN_CHUNK = 4096;
+
+	///	Runs block(first, lanes) over SimdFloat-wide blocks of [0, count) in
+	///	parallel. The last block of a chunk may have fewer than Width lanes;
+	///	it is padded rather than run through a scalar tail, so every element
+	///	takes the same code path.
+	template<typename Block>
+	inline void ForEachSimdBlock(size_t count, size_t threadCount, Block&& block){
+		ParallelFor(count, FASTMATH_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; i += SimdFloat::Width)
+				block(i, MIN(SimdFloat::Width, end - i));
+		}, threadCount);
+	}
+
+	inline SimdFloat LoadLanes(const float* src, size_t lanes){
+		if (lanes == SimdFloat::Width) return SimdFloat::Load(src);
+		alignas(32) float padded[SimdFloat::Width] = {};
+		for (size_t l = 0; l < lanes; ++l) padded[l] = src[l];
+		return SimdFloat::LoadAligned(padded);
+	}
+
+	inline void StoreLanes(const SimdFloat& value, float* dst, size_t lanes){
+		if (lanes == SimdFloat::Width){
+			value.Store(dst);
+			return;
+		}
+		alignas(32) float padded[SimdFloat::Width];
+		value.StoreAligned(padded);
+		for (size_t l = 0; l < lanes; ++l) dst[l] = padded[l];
+	}
+
+	///	Transposes a block of SoA rotation elements into AoS outputs.
+	inline void StoreRotationLanes(const SimdFloat (&r)[9], Matrix3x3* out, size_t lanes){
+		alignas(32) float e[9][SimdFloat::Width];
+		for (size_t k = 0; k < 9; ++k) r[k].StoreAligned(e[k]);
+		for (size_t l = 0; l < lanes; ++l)
+			out[l] = Matrix3x3( e[0][l], e[1][l], e[2][l],
+								e[3][l], e[4][l], e[5][l],
+								e[6][l], e[7][l], e[8][l] );
+	}
+
+	inline void StoreRotationLanes(const SimdFloat (&r)[9], Matrix4x4* out, size_t lanes){
+		alignas(32) float e[9][SimdFloat::Width];
+		for (size_t k = 0; k < 9; ++k) r[k].StoreAligned(e[k]);
+		for (size_t l = 0; l < lanes; ++l)
+			out[l] = Matrix4x4( e[0][l], e[1][l], e[2][l], 0.0f,
+								e[3][l], e[4][l], e[5][l], 0.0f,
+								e[6][l], e[7][l], e[8][l], 0.0f,
+								0.0f,	 0.0f,	  0.0f,	   1.0f );
+	}
+
+	///	Writes the 3x3 rotation and a homogeneous last row/column through the
+	///	view, so external buffers in either layout are filled in place.
+	inline void StoreRotationLanes(const SimdFloat (&r)[9], Mat4ArrayView out, size_t lanes){
+		alignas(32) float e[9][SimdFloat::Width];
+		for (size_t k = 0; k < 9; ++k) r[k].StoreAligned(e[k]);
+		for (size_t l = 0; l < lanes; ++l){
+			for (size_t row = 0; row < 3; ++row){
+				for (size_t column = 0; column < 3; ++column) out.At(l, row, column) = e[row * 3 + column][l];
+				out.At(l, row, 3) = 0.0f;
+				out.At(l, 3, row) = 0.0f;
+			}
+			out.At(l, 3, 3) = 1.0f;
+		}
+	}
+
+	inline void StoreQuaternionLanes(const SimdFloat (&q)[4], Vector4* out, size_t lanes){
+		alignas(32) float e[4][SimdFloat::Width];
+		for (size_t k = 0; k < 4; ++k) q[k].StoreAligned(e[k]);
+		for (size_t l = 0; l < lanes; ++l) out[l] = Vector4(e[0][l], e[1][l], e[2][l], e[3][l]);
+	}
+
+	///	Splits a block of unit axes into SoA lanes.
+	inline void LoadAxisLanes(const Vector3* axes, size_t lanes, SimdFloat& ax, SimdFloat& ay, SimdFloat& az){
+		alignas(32) float x[SimdFloat::Width] = {}, y[SimdFloat::Width] = {}, z[SimdFloat::Width] = {};
+		for (size_t l = 0; l < lanes; ++l){
+			x[l] = getXComponent(axes[l]);
+			y[l] = getYComponent(axes[l]);
+			z[l] = getZComponent(axes[l]);
+		}
+		ax = SimdFloat::LoadAligned(x);
+		ay = SimdFloat::LoadAligned(y);
+		az = SimdFloat::LoadAligned(z);
+	}
+
+	inline void LoadAxisLanes(ConstVec3ArrayView axes, size_t lanes, SimdFloat& ax, SimdFloat& ay, SimdFloat& az){
+		alignas(32) float x[SimdFloat::Width] = {}, y[SimdFloat::Width] = {}, z[SimdFloat::Width] = {};
+		for (size_t l = 0; l < lanes; ++l){
+			x[l] = axes.X(l);
+			y[l] = axes.Y(l);
+			z[l] = axes.Z(l);
+		}
+		ax = SimdFloat::LoadAligned(x);
+		ay = SimdFloat::LoadAligned(y);
+		az = SimdFloat::LoadAligned(z);
+	}
+	///
+	///	Batch internals end
+	///
+
+	///
+	///	Batch entry points
+	///
+	///	sines and cosines may alias angles (not each other).
+	inline void SinCosBatch(const float* angles, size_t count, float* sines, float* cosines, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(SinCosBatch);
+		ForEachSimdBlock(count, threadCount, [&](size_t i, size_t lanes){
+			SimdFloat s, c;
+			FastSinCos(LoadLanes(angles + i, lanes), s, c);
+			StoreLanes(s, sines + i, lanes);
+			StoreLanes(c, cosines + i, lanes);
+		});
+	}
+
+	///	Rotation matrices from SoA Euler angles; see EulerToRotation for the order.
+	template<typename Matrix>
+	inline void RotationFromEulerBatch(const float* yaw, const float* pitch, const float* roll, size_t count,
+									   Matrix* out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(RotationBatch);
+		ForEachSimdBlock(count, threadCount, [&](size_t i, size_t lanes){
+			SimdFloat r[9];
+			EulerToRotation(LoadLanes(yaw + i, lanes), LoadLanes(pitch + i, lanes), LoadLanes(roll + i, lanes), r);
+			StoreRotationLanes(r, out + i, lanes);
+		});
+	}
+
+	///	As above, writing into an external buffer of any layout and stride.
+	inline void RotationFromEulerBatch(const float* yaw, const float* pitch, const float* roll,
+									   Mat4ArrayView out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(RotationBatch);
+		ForEachSimdBlock(out.size(), threadCount, [&](size_t i, size_t lanes){
+			SimdFloat r[9];
+			EulerToRotation(LoadLanes(yaw + i, lanes), LoadLanes(pitch + i, lanes), LoadLanes(roll + i, lanes), r);
+			StoreRotationLanes(r, out.Subview(i, lanes), lanes);
+		});
+	}
+
+	inline void QuaternionFromEulerBatch(const float* yaw, const float* pitch, const float* roll, size_t count,
+										 Vector4* out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(RotationBatch);
+		ForEachSimdBlock(count, threadCount, [&](size_t i, size_t lanes){
+			SimdFloat q[4];
+			EulerToQuaternion(LoadLanes(yaw + i, lanes), LoadLanes(pitch + i, lanes), LoadLanes(roll + i, lanes), q);
+			StoreQuaternionLanes(q, out + i, lanes);
+		});
+	}
+
+	///	Rotation matrices from unit axes and angles in radians.
+	template<typename Matrix>
+	inline void RotationFromAxisAngleBatch(const Vector3* axes, const float* angles, size_t count,
+										   Matrix* out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(RotationBatch);
+		ForEachSimdBlock(count, threadCount, [&](size_t i, size_t lanes){
+			SimdFloat ax, ay, az, r[9];
+			LoadAxisLanes(axes + i, lanes, ax, ay, az);
+			AxisAngleToRotation(ax, ay, az, LoadLanes(angles + i, lanes), r);
+			StoreRotationLanes(r, out + i, lanes);
+		});
+	}
+
+	///	Axes from an interleaved buffer, rotations into an external buffer;
+	///	count is axes.size().
+	inline void RotationFromAxisAngleBatch(ConstVec3ArrayView axes, const float* angles,
+										   Mat4ArrayView out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(RotationBatch);
+		assert(out.size() >= axes.size() && "Mismatched batch sizes!");
+		ForEachSimdBlock(axes.size(), threadCount, [&](size_t i, size_t lanes){
+			SimdFloat ax, ay, az, r[9];
+			LoadAxisLanes(axes.Subview(i, lanes), lanes, ax, ay, az);
+			AxisAngleToRotation(ax, ay, az, LoadLanes(angles + i, lanes), r);
+			StoreRotationLanes(r, out.Subview(i, lanes), lanes);
+		});
+	}
+
+	inline void QuaternionFromAxisAngleBatch(const Vector3* axes, const float* angles, size_t count,
+											 Vector4* out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(RotationBatch);
+		ForEachSimdBlock(count, threadCount, [&](size_t i, size_t lanes){
+			SimdFloat ax, ay, az, q[4];
+			LoadAxisLanes(axes + i, lanes, ax, ay, az);
+			AxisAngleToQuaternion(ax, ay, az, LoadLanes(angles + i, lanes), q);
+			StoreQuaternionLanes(q, out + i, lanes);
+		});
+	}
+	///
+	///	Batch entry points end
+	///
+};
+
+#endif // FGML_FASTMATH_HPP_
\ No newline at end of file
@@ -0,0 +1,513 @@
+#ifndef FGML_INSTRUMENT_HPP_
+#define FGML_INSTRUMENT_HPP_
+
+///
+///	Opt-in hot-path instrumentation.
+///
+///	Define FGML_INSTRUMENT before including any FGML header to count calls
+///	and sampled cycles per operation. Without it every probe expands to
+///	nothing and this header costs nothing.
+///
+///	Counters live in thread-local blocks and are only merged when a
+///	snapshot is requested, so probes never touch shared cache lines.
+///
+///	Calls are also attributed to the innermost active scope label, so a
+///	report shows where the operations come from. FGML_INSTRUMENT_SCOPE
+///	pushes a caller label for the enclosing block, every FGML_SCOPED_TIMER
+///	pushes its operation name, and ParallelFor workers inherit the label of
+///	the thread that forked them.
+///
+
+///
+///	Operation list: X(name, "printable name")
+///
+#define FGML_INSTRUMENT_OPS(X)								\
+	X(Vec2DotProduct,	"Vector2 DotProduct")				\
+	X(Vec2Magnitude,	"Vector2 Magnitude")				\
+	X(Vec2Normalize,	"Vector2 Normalize")				\
+	X(Vec3DotProduct,	"Vector3 DotProduct")				\
+	X(Vec3CrossProduct,	"Vector3 CrossProduct")				\
+	X(Vec3Magnitude,	"Vector3 Magnitude")				\
+	X(Vec3Normalize,	"Vector3 Normalize")				\
+	X(Vec4DotProduct,	"Vector4 DotProduct")				\
+	X(Vec4Magnitude,	"Vector4 Magnitude")				\
+	X(Vec4Normalize,	"Vector4 Normalize")				\
+	X(Mat3Mul,			"Matrix3x3 operator*(Matrix3x3)")	\
+	X(Mat3MulVec,		"Matrix3x3 operator*(Vector3)")		\
+	X(Mat3Determinant,	"Matrix3x3 Determinant")			\
+	X(Mat4Mul,			"Matrix4x4 operator*(Matrix4x4)")	\
+	X(Mat4MulVec,		"Matrix4x4 operator*(Vector4)")		\
+	X(SpatialHashBuild,	"SpatialHash Build")				\
+	X(SpatialHashRadiusBatch,	"SpatialHash QueryRadiusBatch")	\
+	X(SpatialHashKNearestBatch,	"SpatialHash QueryKNearestBatch")	\
+	X(KDTreeBuild,		"KDTree Build")						\
+	X(KDTreeNearestBatch,	"KDTree NearestBatch")			\
+	X(KDTreeKNearestBatch,	"KDTree KNearestBatch")			\
+	X(CollideSpheresBatch,	"CollideSpheresBatch")			\
+	X(CollideCapsulesBatch,	"CollideCapsulesBatch")			\
+	X(CollideOBBsBatch,		"CollideOBBsBatch")				\
+	X(IntegrateSemiImplicitEuler,	"IntegrateSemiImplicitEuler")	\
+	X(IntegrateVerlet,		"IntegrateVerletDrift/Kick")	\
+	X(IntegrateConstraints,	"ApplyDamping/ClampSpeed/ClampToBounds")	\
+	X(SinCosBatch,			"SinCosBatch")					\
+	X(RotationBatch,		"Rotation*Batch")				\
+	X(DecomposeBatch,		"DecomposeBatch")				\
+	X(ComposeBatch,			"ComposeBatch")					\
+	X(WideMultiplyBatch,	"MultiplyBatch")				\
+	X(WideInverseBatch,		"InverseBatch")					\
+	X(WideTransformBatch,	"TransformBatch")				\
+	X(MortonEncodeBatch,	"MortonEncode*Batch")			\
+	X(MortonDecodeBatch,	"MortonDecode*Batch")			\
+	X(MortonSort,			"MortonSort/RadixSortPairs")	\
+	X(MortonReorder,		"ApplyOrder")					\
+	X(AnimationSampleBatch,	"SampleBatch")					\
+	X(AnimationPaletteBatch,	"SamplePaletteBatch")		\
+	X(PipelineRun,			"Pipeline::Run")				\
+	X(SdfDistanceBatch,		"SdfDistanceBatch")				\
+	X(SdfNormalBatch,		"SdfNormalBatch")				\
+	X(MeshFaceNormals,		"ComputeFaceNormals")			\
+	X(MeshFaceTangents,		"ComputeFaceTangents")			\
+	X(MeshVertexNormals,	"ComputeVertexNormals")			\
+	X(MeshVertexTangents,	"ComputeVertexTangents")		\
+	X(CurveEvaluateBatch,	"Curve::EvaluateBatch")			\
+	X(CurveDistanceBatch,	"EvaluateByDistanceBatch")		\
+	X(CurveArcTable,		"Curve arc-length table")
+
+#ifdef FGML_INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+	#define FGML_INSTRUMENT_HAS_RDTSC 1
+#endif
+
+///	One in 2^FGML_INSTRUMENT_SAMPLE_SHIFT calls is timed.
+#ifndef FGML_INSTRUMENT_SAMPLE_SHIFT
+	#define FGML_INSTRUMENT_SAMPLE_SHIFT 6
+#endif
+
+///	Distinct scope labels tracked per thread; later labels go unattributed.
+#ifndef FGML_INSTRUMENT_MAX_SCOPES
+	#define FGML_INSTRUMENT_MAX_SCOPES 64
+#endif
+
+namespace FGML {
+namespace Instrument {
+	///
+	///	Definition of instrumentation types
+	///
+	enum class Op : size_t {
+		#define FGML_INSTRUMENT_ENUM(NAME, LABEL) NAME,
+		FGML_INSTRUMENT_OPS(FGML_INSTRUMENT_ENUM)
+		#undef FGML_INSTRUMENT_ENUM
+		Count
+	};
+
+	const size_t OP_COUNT = static_cast<size_t>(Op::Count);
+
+	struct OpStats {
+		uint64_t calls;
+		uint64_t samples;
+		uint64_t sampledCycles;
+	};
+
+	///	Calls per operation made while label was the innermost scope.
+	struct ScopeStats {
+		const char* label;
+		uint64_t	calls[OP_COUNT];
+	};
+
+	class Snapshot {
+	private:
+		OpStats					m_stats[OP_COUNT];
+		std::vector<ScopeStats> m_scopes;
+	public:
+		Snapshot();
+
+		inline const OpStats& operator[](Op op) const;
+		inline OpStats&		  operator[](Op op);
+
+		inline const std::vector<ScopeStats>& Scopes(void) const;
+		///	Labels compare by contents, so equal literals from different
+		///	translation units merge; creates the entry if it is missing.
+		inline ScopeStats& ScopeEntry(const char* label);
+		inline uint64_t	   ScopedCalls(const char* label, Op op) const;
+
+		friend inline Snapshot operator-(const Snapshot& later, const Snapshot& earlier);
+
+		friend std::ostream& operator<<(std::ostream& out, const Snapshot& snap);
+	};
+
+	///	Per-thread counter block; written only by its owning thread. Scope
+	///	slots are assigned on first use and keep their label until exit.
+	class ThreadCounters {
+	private:
+		static const size_t NoScope = ~size_t(0);
+
+		std::atomic<uint64_t>	 m_calls[OP_COUNT];
+		std::atomic<uint64_t>	 m_samples[OP_COUNT];
+		std::atomic<uint64_t>	 m_cycles[OP_COUNT];
+
+		std::atomic<const char*> m_scopeLabels[FGML_INSTRUMENT_MAX_SCOPES];
+		std::atomic<uint64_t>	 m_scopeCalls[FGML_INSTRUMENT_MAX_SCOPES][OP_COUNT];
+		std::atomic<size_t>		 m_scopeCount;
+		std::vector<size_t>		 m_scopeStack;	// slot per active scope; owner only
+
+		inline size_t ScopeSlot(const char* label);
+	public:
+		ThreadCounters();
+		ThreadCounters(const ThreadCounters&) = delete;
+		ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+		inline bool Hit(Op op);
+		inline void AddCycles(Op op, uint64_t cycles);
+		inline void Accumulate(Snapshot& snap) const;
+		inline void Reset(void);
+
+		///	label must outlive the thread, e.g. a string literal; nullptr
+		///	opens an unattributed scope.
+		inline void		   PushScope(const char* label);
+		inline void		   PopScope(void);
+		inline const char* CurrentScope(void) const;
+
+		~ThreadCounters();
+	};
+
+	///	Counts one call and times it when the call falls on a sample.
+	class Probe {
+	private:
+		ThreadCounters* m_counters;
+		Op				m_op;
+		uint64_t		m_start;
+	public:
+		explicit Probe(Op op);
+		Probe(const Probe&) = delete;
+		Probe& operator=(const Probe&) = delete;
+		~Probe();
+	};
+
+	///	Attributes calls on this thread to label until the end of the block.
+	class Scope {
+	public:
+		explicit Scope(const char* label);
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+	};
+
+	///	Times every entry; meant for batch kernels, not per-element math.
+	///	The timer's own call counts under the enclosing scope, and calls it
+	///	makes count under its operation name.
+	class ScopedTimer {
+	private:
+		Op		 m_op;
+		uint64_t m_start;
+	public:
+		explicit ScopedTimer(Op op);
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+		~ScopedTimer();
+	};
+	///
+	///	Definition of instrumentation types end
+	///
+
+	///
+	///	Declaration of instrumentation internals
+	///
+	inline const char* OpName(Op op){
+		static const char* const names[OP_COUNT] = {
+			#define FGML_INSTRUMENT_NAME(NAME, LABEL) LABEL,
+			FGML_INSTRUMENT_OPS(FGML_INSTRUMENT_NAME)
+			#undef FGML_INSTRUMENT_NAME
+		};
+		return names[static_cast<size_t>(op)];
+	}
+
+	inline uint64_t ReadCycles(void){
+	#ifdef FGML_INSTRUMENT_HAS_RDTSC
+		return static_cast<uint64_t>(__rdtsc());
+	#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+	#endif
+	}
+
+	struct Registry {
+		std::mutex					 lock;
+		std::vector<ThreadCounters*> live;
+		Snapshot					 retired;
+	};
+
+	inline Registry& GetRegistry(void){
+		static Registry registry;
+		return registry;
+	}
+
+	inline ThreadCounters& LocalCounters(void){
+		thread_local ThreadCounters counters;
+		return counters;
+	}
+
+	inline Snapshot::Snapshot() : m_stats{}, m_scopes() {}
+
+	inline const OpStats& Snapshot::operator[](Op op) const {
+		return m_stats[static_cast<size_t>(op)];
+	}
+
+	inline OpStats& Snapshot::operator[](Op op){
+		return m_stats[static_cast<size_t>(op)];
+	}
+
+	inline const std::vector<ScopeStats>& Snapshot::Scopes(void) const {
+		return m_scopes;
+	}
+
+	inline ScopeStats& Snapshot::ScopeEntry(const char* label){
+		for (ScopeStats& scope : m_scopes){
+			if (scope.label == label || std::strcmp(scope.label, label) == 0) return scope;
+		}
+		m_scopes.push_back(ScopeStats{ label, {} });
+		return m_scopes.back();
+	}
+
+	inline uint64_t Snapshot::ScopedCalls(const char* label, Op op) const {
+		for (const ScopeStats& scope : m_scopes){
+			if (scope.label == label || std::strcmp(scope.label, label) == 0) return scope.calls[static_cast<size_t>(op)];
+		}
+		return 0;
+	}
+
+	inline Snapshot operator-(const Snapshot& later, const Snapshot& earlier){
+		Snapshot diff;
+		for (size_t i = 0; i < OP_COUNT; ++i){
+			diff.m_stats[i].calls		  = later.m_stats[i].calls		   - earlier.m_stats[i].calls;
+			diff.m_stats[i].samples		  = later.m_stats[i].samples	   - earlier.m_stats[i].samples;
+			diff.m_stats[i].sampledCycles = later.m_stats[i].sampledCycles - earlier.m_stats[i].sampledCycles;
+		}
+		for (const ScopeStats& scope : later.m_scopes){
+			ScopeStats& out = diff.ScopeEntry(scope.label);
+			for (size_t i = 0; i < OP_COUNT; ++i) out.calls[i] = scope.calls[i] - earlier.ScopedCalls(scope.label, static_cast<Op>(i));
+		}
+		return diff;
+	}
+
+	inline std::ostream& operator<<(std::ostream& out, const Snapshot& snap){
+		out << "FGML instrumentation (1/" << (1u << FGML_INSTRUMENT_SAMPLE_SHIFT) << " calls sampled)\n";
+		for (size_t i = 0; i < OP_COUNT; ++i){
+			const OpStats& s = snap.m_stats[i];
+			if (s.calls == 0) continue;
+
+			out << "  " << OpName(static_cast<Op>(i))
+				<< ": calls=" << s.calls
+				<< " samples=" << s.samples
+				<< " cycles/call=" << (s.samples ? s.sampledCycles / s.samples : 0)
+				<< "\n";
+		}
+		for (const ScopeStats& scope : snap.m_scopes){
+			bool header = false;
+			for (size_t i = 0; i < OP_COUNT; ++i){
+				if (scope.calls[i] == 0) continue;
+				if (!header){
+					out << "  in " << scope.label << ":\n";
+					header = true;
+				}
+				out << "    " << OpName(static_cast<Op>(i)) << ": calls=" << scope.calls[i] << "\n";
+			}
+		}
+		return out;
+	}
+
+	inline ThreadCounters::ThreadCounters() : m_scopeCount(0) {
+		for (size_t s = 0; s < FGML_INSTRUMENT_MAX_SCOPES; ++s) this->m_scopeLabels[s].store(nullptr, std::memory_order_relaxed);
+		this->Reset();
+		Registry& reg = GetRegistry();
+		std::lock_guard<std::mutex> guard(reg.lock);
+		reg.live.push_back(this);
+	}
+
+	inline ThreadCounters::~ThreadCounters(){
+		Registry& reg = GetRegistry();
+		std::lock_guard<std::mutex> guard(reg.lock);
+		this->Accumulate(reg.retired);
+		for (size_t i = 0; i < reg.live.size(); ++i){
+			if (reg.live[i] == this){
+				reg.live[i] = reg.live.back();
+				reg.live.pop_back();
+				break;
+			}
+		}
+	}
+
+	inline bool ThreadCounters::Hit(Op op){
+		const size_t i = static_cast<size_t>(op);
+		const uint64_t calls = this->m_calls[i].load(std::memory_order_relaxed) + 1;
+		this->m_calls[i].store(calls, std::memory_order_relaxed);
+		if (!this->m_scopeStack.empty() && this->m_scopeStack.back() != NoScope){
+			std::atomic<uint64_t>& scoped = this->m_scopeCalls[this->m_scopeStack.back()][i];
+			scoped.store(scoped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+		return (calls & ((uint64_t(1) << FGML_INSTRUMENT_SAMPLE_SHIFT) - 1)) == 0;
+	}
+
+	inline void ThreadCounters::AddCycles(Op op, uint64_t cycles){
+		const size_t i = static_cast<size_t>(op);
+		this->m_samples[i].store(this->m_samples[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		this->m_cycles[i].store(this->m_cycles[i].load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+	}
+
+	inline void ThreadCounters::Accumulate(Snapshot& snap) const {
+		for (size_t i = 0; i < OP_COUNT; ++i){
+			OpStats& s = snap[static_cast<Op>(i)];
+			s.calls			+= this->m_calls[i].load(std::memory_order_relaxed);
+			s.samples		+= this->m_samples[i].load(std::memory_order_relaxed);
+			s.sampledCycles += this->m_cycles[i].load(std::memory_order_relaxed);
+		}
+
+		const size_t scopes = this->m_scopeCount.load(std::memory_order_acquire);
+		for (size_t slot = 0; slot < scopes; ++slot){
+			ScopeStats& scope = snap.ScopeEntry(this->m_scopeLabels[slot].load(std::memory_order_relaxed));
+			for (size_t i = 0; i < OP_COUNT; ++i) scope.calls[i] += this->m_scopeCalls[slot][i].load(std::memory_order_relaxed);
+		}
+	}
+
+	inline void ThreadCounters::Reset(void){
+		for (size_t i = 0; i < OP_COUNT; ++i){
+			this->m_calls[i].store(0, std::memory_order_relaxed);
+			this->m_samples[i].store(0, std::memory_order_relaxed);
+			this->m_cycles[i].store(0, std::memory_order_relaxed);
+		}
+		for (size_t slot = 0; slot < FGML_INSTRUMENT_MAX_SCOPES; ++slot){
+			for (size_t i = 0; i < OP_COUNT; ++i) this->m_scopeCalls[slot][i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	///	Linear in the labels seen so far; scopes open per batch or per
+	///	system, not per element.
+	inline size_t ThreadCounters::ScopeSlot(const char* label){
+		const size_t count = this->m_scopeCount.load(std::memory_order_relaxed);
+		for (size_t slot = 0; slot < count; ++slot){
+			const char* known = this->m_scopeLabels[slot].load(std::memory_order_relaxed);
+			if (known == label || std::strcmp(known, label) == 0) return slot;
+		}
+		if (count == FGML_INSTRUMENT_MAX_SCOPES) return NoScope;
+
+		// Publish the label before the count so snapshots never see an empty slot.
+		this->m_scopeLabels[count].store(label, std::memory_order_relaxed);
+		this->m_scopeCount.store(count + 1, std::memory_order_release);
+		return count;
+	}
+
+	inline void ThreadCounters::PushScope(const char* label){
+		this->m_scopeStack.push_back((label != nullptr) ? this->ScopeSlot(label) : NoScope);
+	}
+
+	inline void ThreadCounters::PopScope(void){
+		this->m_scopeStack.pop_back();
+	}
+
+	inline const char* ThreadCounters::CurrentScope(void) const {
+		if (this->m_scopeStack.empty() || this->m_scopeStack.back() == NoScope) return nullptr;
+		return this->m_scopeLabels[this->m_scopeStack.back()].load(std::memory_order_relaxed);
+	}
+
+	inline Probe::Probe(Op op)
+	: m_counters(&LocalCounters()), m_op(op), m_start(0) {
+		if (this->m_counters->Hit(op)){
+			this->m_start = ReadCycles();
+		}
+	}
+
+	inline Probe::~Probe(){
+		if (this->m_start != 0){
+			this->m_counters->AddCycles(this->m_op, ReadCycles() - this->m_start);
+		}
+	}
+
+	inline Scope::Scope(const char* label){
+		LocalCounters().PushScope(label);
+	}
+
+	inline Scope::~Scope(){
+		LocalCounters().PopScope();
+	}
+
+	inline ScopedTimer::ScopedTimer(Op op)
+	: m_op(op), m_start(0) {
+		ThreadCounters& counters = LocalCounters();
+		counters.Hit(op);
+		counters.PushScope(OpName(op));
+		this->m_start = ReadCycles();
+	}
+
+	inline ScopedTimer::~ScopedTimer(){
+		const uint64_t end = ReadCycles();
+		ThreadCounters& counters = LocalCounters();
+		counters.PopScope();
+		counters.AddCycles(this->m_op, end - this->m_start);
+	}
+	///
+	///	Declaration of instrumentation internals end
+	///
+
+	///
+	///	Public snapshot/report API
+	///
+	inline Snapshot TakeSnapshot(void){
+		Registry& reg = GetRegistry();
+		std::lock_guard<std::mutex> guard(reg.lock);
+		Snapshot snap = reg.retired;
+		for (const ThreadCounters* counters : reg.live){
+			counters->Accumulate(snap);
+		}
+		return snap;
+	}
+
+	///	Not synchronised with running probes; call between frames.
+	inline void ResetCounters(void){
+		Registry& reg = GetRegistry();
+		std::lock_guard<std::mutex> guard(reg.lock);
+		reg.retired = Snapshot();
+		for (ThreadCounters* counters : reg.live){
+			counters->Reset();
+		}
+	}
+
+	inline void Report(std::ostream& out){
+		out << TakeSnapshot();
+	}
+
+	///	Innermost scope label on the calling thread, or nullptr.
+	inline const char* CurrentScope(void){
+		return LocalCounters().CurrentScope();
+	}
+	///
+	///	Public snapshot/report API end
+	///
+};
+};
+
+#define FGML_PROBE(OP)			::FGML::Instrument::Probe		fgmlProbe_(::FGML::Instrument::Op::OP)
+#define FGML_SCOPED_TIMER(OP)	::FGML::Instrument::ScopedTimer fgmlTimer_(::FGML::Instrument::Op::OP)
+#define FGML_INSTRUMENT_SCOPE(LABEL)	::FGML::Instrument::Scope fgmlScope_(LABEL)
+
+#else // FGML_INSTRUMENT
+
+#define FGML_PROBE(OP)			((void)0)
+#define FGML_SCOPED_TIMER(OP)	((void)0)
+#define FGML_INSTRUMENT_SCOPE(LABEL)	((void)0)
+
+#endif // FGML_INSTRUMENT
+
+#endif // FGML_INSTRUMENT_HPP_
\ No newline at end of file
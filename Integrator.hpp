@@ -0,0 +1,298 @@
+#ifndef FGML_INTEGRATOR_HPP_
+#define FGML_INTEGRATOR_HPP_
+
+#include <cassert>
+#include <cstddef>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+
+namespace FGML {
+	///
+	///	Definition of ParticleStreams
+	///
+	///	Non-owning SoA view over particle state. Force and inverse-mass
+	///	streams may be null; a null force stream means gravity only and a null
+	///	inverse-mass stream means unit mass. All kernels update in place.
+	///
+	struct ParticleStreams {
+		float*		 px;
+		float*		 py;
+		float*		 pz;
+		float*		 vx;
+		float*		 vy;
+		float*		 vz;
+		const float* fx;
+		const float* fy;
+		const float* fz;
+		const float* invMass;
+		size_t		 count;
+	};
+
+	///	Particles per worker chunk; large enough to amortise the fork.
+	const size_t INTEGRATOR_MIN_CHUNK = 16384;
+	///
+	///	Definition of ParticleStreams end
+	///
+
+	///
+	///	Kernel internals
+	///
+	///	Runs simdBody(i) over full SimdFloat blocks of [begin, end), then
+	///	scalarBody(i) over the tail. Kernels pass the same generic lambda
+	///	instantiated for SimdFloat and float, so each kernel has one source.
+	template<typename SimdBody, typename ScalarBody>
+	inline void ForEachParticle(size_t begin, size_t end, SimdBody&& simdBody, ScalarBody&& scalarBody){
+		size_t i = begin;
+		for (; i + SimdFloat::Width <= end; i += SimdFloat::Width) simdBody(i);
+		for (; i < end; ++i) scalarBody(i);
+	}
+
+	///	Acceleration for particle i: gravity plus force * invMass.
+	template<typename T, typename LoadFn>
+	inline void ParticleAcceleration(const ParticleStreams& s, size_t i, const Vector3& gravity, LoadFn load,
+									 T& ax, T& ay, T& az){
+		ax = T(getXComponent(gravity));
+		ay = T(getYComponent(gravity));
+		az = T(getZComponent(gravity));
+		if (s.fx == nullptr) return;
+
+		const T invMass = (s.invMass != nullptr) ? load(s.invMass + i) : T(1.0f);
+		ax = MulAdd(load(s.fx + i), invMass, ax);
+		ay = MulAdd(load(s.fy + i), invMass, ay);
+		az = MulAdd(load(s.fz + i), invMass, az);
+	}
+
+	inline SimdFloat LoadSimd(const float* src){ return SimdFloat::Load(src); }
+	inline float	 LoadScalar(const float* src){ return *src; }
+	inline void		 StoreSimd(float* dst, const SimdFloat& value){ value.Store(dst); }
+	inline void		 StoreScalar(float* dst, float value){ *dst = value; }
+
+	///
+	///	Kernel internals end
+	///
+
+	///
+	///	Integrators
+	///
+	///	Semi-implicit (symplectic) Euler. Forces are held constant across the
+	///	substeps sub-steps of length dt / substeps.
+	inline void IntegrateSemiImplicitEuler(const ParticleStreams& s, float dt, const Vector3& gravity,
+										   size_t substeps = 1, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(IntegrateSemiImplicitEuler);
+		assert(substeps > 0 && "At least one sub-step is required");
+		const float h = dt / static_cast<float>(substeps);
+
+		auto body = [&](auto zero, size_t i, auto load, auto store){
+			using T = decltype(zero);
+			T ax, ay, az;
+			ParticleAcceleration<T>(s, i, gravity, load, ax, ay, az);
+
+			T px = load(s.px + i), py = load(s.py + i), pz = load(s.pz + i);
+			T vx = load(s.vx + i), vy = load(s.vy + i), vz = load(s.vz + i);
+			const T step(h);
+
+			// State stays in registers across sub-steps.
+			for (size_t n = 0; n < substeps; ++n){
+				vx = MulAdd(ax, step, vx);
+				vy = MulAdd(ay, step, vy);
+				vz = MulAdd(az, step, vz);
+				px = MulAdd(vx, step, px);
+				py = MulAdd(vy, step, py);
+				pz = MulAdd(vz, step, pz);
+			}
+
+			store(s.px + i, px); store(s.py + i, py); store(s.pz + i, pz);
+			store(s.vx + i, vx); store(s.vy + i, vy); store(s.vz + i, vz);
+		};
+
+		ParallelFor(s.count, INTEGRATOR_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			ForEachParticle(begin, end,
+				[&](size_t i){ body(SimdFloat::Zero(), i, LoadSimd, StoreSimd); },
+				[&](size_t i){ body(0.0f, i, LoadScalar, StoreScalar); });
+		}, threadCount);
+	}
+
+	///	Velocity Verlet, first half: v += a * dt / 2; p += v * dt.
+	///	Recompute forces afterwards, then call IntegrateVerletKick.
+	inline void IntegrateVerletDrift(const ParticleStreams& s, float dt, const Vector3& gravity, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(IntegrateVerlet);
+
+		auto body = [&](auto zero, size_t i, auto load, auto store){
+			using T = decltype(zero);
+			T ax, ay, az;
+			ParticleAcceleration<T>(s, i, gravity, load, ax, ay, az);
+
+			const T halfDt(0.5f * dt), h(dt);
+			const T vx = MulAdd(ax, halfDt, load(s.vx + i));
+			const T vy = MulAdd(ay, halfDt, load(s.vy + i));
+			const T vz = MulAdd(az, halfDt, load(s.vz + i));
+
+			store(s.vx + i, vx); store(s.vy + i, vy); store(s.vz + i, vz);
+			store(s.px + i, MulAdd(vx, h, load(s.px + i)));
+			store(s.py + i, MulAdd(vy, h, load(s.py + i)));
+			store(s.pz + i, MulAdd(vz, h, load(s.pz + i)));
+		};
+
+		ParallelFor(s.count, INTEGRATOR_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			ForEachParticle(begin, end,
+				[&](size_t i){ body(SimdFloat::Zero(), i, LoadSimd, StoreSimd); },
+				[&](size_t i){ body(0.0f, i, LoadScalar, StoreScalar); });
+		}, threadCount);
+	}
+
+	///	Velocity Verlet, second half with the new forces: v += a * dt / 2.
+	inline void IntegrateVerletKick(const ParticleStreams& s, float dt, const Vector3& gravity, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(IntegrateVerlet);
+
+		auto body = [&](auto zero, size_t i, auto load, auto store){
+			using T = decltype(zero);
+			T ax, ay, az;
+			ParticleAcceleration<T>(s, i, gravity, load, ax, ay, az);
+
+			const T halfDt(0.5f * dt);
+			store(s.vx + i, MulAdd(ax, halfDt, load(s.vx + i)));
+			store(s.vy + i, MulAdd(ay, halfDt, load(s.vy + i)));
+			store(s.vz + i, MulAdd(az, halfDt, load(s.vz + i)));
+		};
+
+		ParallelFor(s.count, INTEGRATOR_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			ForEachParticle(begin, end,
+				[&](size_t i){ body(SimdFloat::Zero(), i, LoadSimd, StoreSimd); },
+				[&](size_t i){ body(0.0f, i, LoadScalar, StoreScalar); });
+		}, threadCount);
+	}
+
+	///	Convenience for constant forces: drift and kick fused into one pass,
+	///	sub-stepped per particle with the state held in registers.
+	inline void IntegrateVelocityVerlet(const ParticleStreams& s, float dt, const Vector3& gravity,
+										size_t substeps = 1, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(IntegrateVerlet);
+		assert(substeps > 0 && "At least one sub-step is required");
+		const float h = dt / static_cast<float>(substeps);
+
+		auto body = [&](auto zero, size_t i, auto load, auto store){
+			using T = decltype(zero);
+			T ax, ay, az;
+			ParticleAcceleration<T>(s, i, gravity, load, ax, ay, az);
+
+			T px = load(s.px + i), py = load(s.py + i), pz = load(s.pz + i);
+			T vx = load(s.vx + i), vy = load(s.vy + i), vz = load(s.vz + i);
+			const T halfStep(0.5f * h), step(h);
+
+			// Same kick / drift / kick sequence as the split kernels.
+			for (size_t n = 0; n < substeps; ++n){
+				vx = MulAdd(ax, halfStep, vx);
+				vy = MulAdd(ay, halfStep, vy);
+				vz = MulAdd(az, halfStep, vz);
+				px = MulAdd(vx, step, px);
+				py = MulAdd(vy, step, py);
+				pz = MulAdd(vz, step, pz);
+				vx = MulAdd(ax, halfStep, vx);
+				vy = MulAdd(ay, halfStep, vy);
+				vz = MulAdd(az, halfStep, vz);
+			}
+
+			store(s.px + i, px); store(s.py + i, py); store(s.pz + i, pz);
+			store(s.vx + i, vx); store(s.vy + i, vy); store(s.vz + i, vz);
+		};
+
+		ParallelFor(s.count, INTEGRATOR_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			ForEachParticle(begin, end,
+				[&](size_t i){ body(SimdFloat::Zero(), i, LoadSimd, StoreSimd); },
+				[&](size_t i){ body(0.0f, i, LoadScalar, StoreScalar); });
+		}, threadCount);
+	}
+	///
+	///	Integrators end
+	///
+
+	///
+	///	Position-based post passes
+	///
+	///	Implicit (rational) velocity damping: v *= 1 / (1 + damping * dt).
+	///	Stable for any damping * dt >= 0; first-order match to exp(-damping * dt).
+	inline void ApplyDamping(const ParticleStreams& s, float damping, float dt, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(IntegrateConstraints);
+		const float factor = 1.0f / (1.0f + damping * dt);
+
+		ParallelFor(s.count, INTEGRATOR_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			const SimdFloat f(factor);
+			ForEachParticle(begin, end,
+				[&](size_t i){
+					(SimdFloat::Load(s.vx + i) * f).Store(s.vx + i);
+					(SimdFloat::Load(s.vy + i) * f).Store(s.vy + i);
+					(SimdFloat::Load(s.vz + i) * f).Store(s.vz + i);
+				},
+				[&](size_t i){
+					s.vx[i] *= factor;
+					s.vy[i] *= factor;
+					s.vz[i] *= factor;
+				});
+		}, threadCount);
+	}
+
+	///	Rescales any velocity longer than maxSpeed, comparing squared lengths.
+	inline void ClampSpeed(const ParticleStreams& s, float maxSpeed, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(IntegrateConstraints);
+		assert(maxSpeed >= 0.0f && "Negative speed limit");
+
+		auto body = [&](auto zero, size_t i, auto load, auto store){
+			using T = decltype(zero);
+			const T vx = load(s.vx + i), vy = load(s.vy + i), vz = load(s.vz + i);
+			const T speedSq = MulAdd(vx, vx, MulAdd(vy, vy, vz * vz));
+			const T limitSq(SQR(maxSpeed));
+			// Only lanes over the limit divide, so a zero limit leaves resting particles at 0.
+			const T scale = Select(CmpGt(speedSq, limitSq), T(maxSpeed) / Sqrt(speedSq), T(1.0f));
+			store(s.vx + i, vx * scale);
+			store(s.vy + i, vy * scale);
+			store(s.vz + i, vz * scale);
+		};
+
+		ParallelFor(s.count, INTEGRATOR_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			ForEachParticle(begin, end,
+				[&](size_t i){ body(SimdFloat::Zero(), i, LoadSimd, StoreSimd); },
+				[&](size_t i){ body(0.0f, i, LoadScalar, StoreScalar); });
+		}, threadCount);
+	}
+
+	///	Projects positions into [boxMin, boxMax]; the velocity component that
+	///	pushed through a wall is zeroed.
+	inline void ClampToBounds(const ParticleStreams& s, const Vector3& boxMin, const Vector3& boxMax, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(IntegrateConstraints);
+		const float lo[3] = { getXComponent(boxMin), getYComponent(boxMin), getZComponent(boxMin) };
+		const float hi[3] = { getXComponent(boxMax), getYComponent(boxMax), getZComponent(boxMax) };
+		float* const pos[3] = { s.px, s.py, s.pz };
+		float* const vel[3] = { s.vx, s.vy, s.vz };
+
+		ParallelFor(s.count, INTEGRATOR_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t a = 0; a < 3; ++a){
+				const SimdFloat vlo(lo[a]), vhi(hi[a]);
+				ForEachParticle(begin, end,
+					[&](size_t i){
+						const SimdFloat p = SimdFloat::Load(pos[a] + i);
+						const SimdFloat clamped = Min(Max(p, vlo), vhi);
+						const SimdFloat inside = CmpEq(p, clamped);
+						clamped.Store(pos[a] + i);
+						And(inside, SimdFloat::Load(vel[a] + i)).Store(vel[a] + i);
+					},
+					[&](size_t i){
+						const float p = pos[a][i];
+						const float clamped = MIN(MAX(p, lo[a]), hi[a]);
+						if (clamped != p){
+							pos[a][i] = clamped;
+							vel[a][i] = 0.0f;
+						}
+					});
+			}
+		}, threadCount);
+	}
+	///
+	///	Position-based post passes end
+	///
+};
+
+#endif // FGML_INTEGRATOR_HPP_
\ No newline at end of file
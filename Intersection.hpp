@@ -0,0 +1,404 @@
+#ifndef FGML_INTERSECTION_HPP_
+#define FGML_INTERSECTION_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Macros.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+
+namespace FGML {
+	///
+	///	Definition of ray packet types
+	///
+	///	A packet holds SimdFloat::Width rays in SoA. Kernels only report hits
+	///	closer than the lane's current hit distance, so a packet can be run
+	///	against many primitives and ends up holding the closest one. Hits need
+	///	t > 0 with no tolerance, so offset secondary ray origins off surfaces.
+	///
+	const size_t RAY_PACKET_WIDTH = SimdFloat::Width;
+
+	struct RayPacket {
+		alignas(32) float ox[RAY_PACKET_WIDTH];
+		alignas(32) float oy[RAY_PACKET_WIDTH];
+		alignas(32) float oz[RAY_PACKET_WIDTH];
+		alignas(32) float dx[RAY_PACKET_WIDTH];
+		alignas(32) float dy[RAY_PACKET_WIDTH];
+		alignas(32) float dz[RAY_PACKET_WIDTH];
+
+		inline void Set(size_t lane, const Vector3& origin, const Vector3& direction);
+	};
+
+	struct HitPacket {
+		alignas(32) float	 t[RAY_PACKET_WIDTH];
+		alignas(32) float	 u[RAY_PACKET_WIDTH];
+		alignas(32) float	 v[RAY_PACKET_WIDTH];
+		alignas(32) uint32_t primitive[RAY_PACKET_WIDTH];
+		int					 mask;
+
+		inline void Reset(float tMax = std::numeric_limits<float>::infinity());
+	};
+
+	struct RayHit {
+		float	 t;
+		float	 u;
+		float	 v;
+		uint32_t primitive;
+	};
+	///
+	///	Definition of ray packet types end
+	///
+
+	///
+	///	Definition of TriangleSoA class
+	///
+	///	Triangles stored as vertex 0 plus both edges, padded with degenerate
+	///	triangles to a multiple of the SIMD width.
+	///
+	class TriangleSoA {
+	private:
+		size_t			   m_count;
+		std::vector<float> m_v0[3];
+		std::vector<float> m_e1[3];
+		std::vector<float> m_e2[3];
+	public:
+		TriangleSoA();
+
+		inline void Clear(void);
+		inline void Add(const Vector3& v0, const Vector3& v1, const Vector3& v2);
+
+		inline size_t Size(void) const;
+
+		friend inline bool IntersectRayTriangles(const Vector3& origin, const Vector3& direction,
+												 const TriangleSoA& tris, float tMax, RayHit& hit);
+
+		~TriangleSoA() = default;
+	};
+	///
+	///	Definition of TriangleSoA class end
+	///
+
+	///
+	///	Declaration of ray packet methods
+	///
+	inline void RayPacket::Set(size_t lane, const Vector3& origin, const Vector3& direction){
+		assert(lane < RAY_PACKET_WIDTH && "Going beyond the packet");
+		this->ox[lane] = getXComponent(origin);
+		this->oy[lane] = getYComponent(origin);
+		this->oz[lane] = getZComponent(origin);
+		this->dx[lane] = getXComponent(direction);
+		this->dy[lane] = getYComponent(direction);
+		this->dz[lane] = getZComponent(direction);
+	}
+
+	inline void HitPacket::Reset(float tMax){
+		for (size_t lane = 0; lane < RAY_PACKET_WIDTH; ++lane){
+			this->t[lane]		  = tMax;
+			this->u[lane]		  = 0.0f;
+			this->v[lane]		  = 0.0f;
+			this->primitive[lane] = std::numeric_limits<uint32_t>::max();
+		}
+		this->mask = 0;
+	}
+
+	///	Writes the lanes set in laneMask back into the packet.
+	inline void CommitHits(HitPacket& hits, int laneMask, const SimdFloat& t, const SimdFloat& u, const SimdFloat& v, uint32_t primitive){
+		alignas(32) float tl[RAY_PACKET_WIDTH], ul[RAY_PACKET_WIDTH], vl[RAY_PACKET_WIDTH];
+		t.StoreAligned(tl);
+		u.StoreAligned(ul);
+		v.StoreAligned(vl);
+
+		for (size_t lane = 0; lane < RAY_PACKET_WIDTH; ++lane){
+			if (!(laneMask & (1 << lane))) continue;
+			hits.t[lane]		 = tl[lane];
+			hits.u[lane]		 = ul[lane];
+			hits.v[lane]		 = vl[lane];
+			hits.primitive[lane] = primitive;
+		}
+		hits.mask |= laneMask;
+	}
+	///
+	///	Declaration of ray packet methods end
+	///
+
+	///
+	///	Declaration of TriangleSoA methods
+	///
+	inline TriangleSoA::TriangleSoA() : m_count(0) {}
+
+	inline void TriangleSoA::Clear(void){
+		this->m_count = 0;
+		for (size_t a = 0; a < 3; ++a){
+			this->m_v0[a].clear();
+			this->m_e1[a].clear();
+			this->m_e2[a].clear();
+		}
+	}
+
+	inline void TriangleSoA::Add(const Vector3& v0, const Vector3& v1, const Vector3& v2){
+		const Vector3 e1 = v1 - v0;
+		const Vector3 e2 = v2 - v0;
+		const float p0[3] = { getXComponent(v0), getYComponent(v0), getZComponent(v0) };
+		const float p1[3] = { getXComponent(e1), getYComponent(e1), getZComponent(e1) };
+		const float p2[3] = { getXComponent(e2), getYComponent(e2), getZComponent(e2) };
+
+		// Overwrite the first padding slot if there is one, then re-pad.
+		const size_t slot = this->m_count++;
+		const size_t padded = (this->m_count + SimdFloat::Width - 1) / SimdFloat::Width * SimdFloat::Width;
+		for (size_t a = 0; a < 3; ++a){
+			this->m_v0[a].resize(padded, 0.0f);
+			this->m_e1[a].resize(padded, 0.0f);
+			this->m_e2[a].resize(padded, 0.0f);
+			this->m_v0[a][slot] = p0[a];
+			this->m_e1[a][slot] = p1[a];
+			this->m_e2[a][slot] = p2[a];
+		}
+	}
+
+	inline size_t TriangleSoA::Size(void) const {
+		return this->m_count;
+	}
+	///
+	///	Declaration of TriangleSoA methods end
+	///
+
+	///
+	///	Scalar reference kernel
+	///
+	///	Moller-Trumbore; returns the hit distance and barycentrics of v1 and v2.
+	inline bool IntersectRayTriangle(const Vector3& origin, const Vector3& direction,
+									 const Vector3& v0, const Vector3& v1, const Vector3& v2,
+									 float& t, float& u, float& v){
+		const Vector3 e1 = v1 - v0;
+		const Vector3 e2 = v2 - v0;
+		const Vector3 p	 = CrossProduct(direction, e2);
+		const float det	 = DotProduct(e1, p);
+		// Only an exact zero is rejected: det scales with |e1| |e2| |d|, so any
+		// fixed cutoff drops small triangles, and near-parallel rays fail the
+		// barycentric tests below.
+		if (det == 0.0f) return false;
+
+		const float invDet = 1.0f / det;
+		const Vector3 s = origin - v0;
+		u = DotProduct(s, p) * invDet;
+		if (u < 0.0f || u > 1.0f) return false;
+
+		const Vector3 q = CrossProduct(s, e1);
+		v = DotProduct(direction, q) * invDet;
+		if (v < 0.0f || u + v > 1.0f) return false;
+
+		t = DotProduct(e2, q) * invDet;
+		return t > 0.0f;
+	}
+	///
+	///	Scalar reference kernel end
+	///
+
+	///
+	///	Packet kernels: RAY_PACKET_WIDTH rays against one primitive
+	///
+	///	Each returns the lane mask of rays whose closest hit was updated.
+	inline int IntersectPacketTriangle(const RayPacket& rays, const Vector3& v0, const Vector3& v1, const Vector3& v2,
+									   uint32_t primitive, HitPacket& hits){
+		const SimdFloat e1x(getXComponent(v1) - getXComponent(v0));
+		const SimdFloat e1y(getYComponent(v1) - getYComponent(v0));
+		const SimdFloat e1z(getZComponent(v1) - getZComponent(v0));
+		const SimdFloat e2x(getXComponent(v2) - getXComponent(v0));
+		const SimdFloat e2y(getYComponent(v2) - getYComponent(v0));
+		const SimdFloat e2z(getZComponent(v2) - getZComponent(v0));
+
+		const SimdFloat dx = SimdFloat::LoadAligned(rays.dx);
+		const SimdFloat dy = SimdFloat::LoadAligned(rays.dy);
+		const SimdFloat dz = SimdFloat::LoadAligned(rays.dz);
+
+		const SimdFloat px = dy * e2z - dz * e2y;
+		const SimdFloat py = dz * e2x - dx * e2z;
+		const SimdFloat pz = dx * e2y - dy * e2x;
+		const SimdFloat det = MulAdd(e1x, px, MulAdd(e1y, py, e1z * pz));
+		const SimdFloat invDet = SimdFloat(1.0f) / det;
+
+		const SimdFloat sx = SimdFloat::LoadAligned(rays.ox) - SimdFloat(getXComponent(v0));
+		const SimdFloat sy = SimdFloat::LoadAligned(rays.oy) - SimdFloat(getYComponent(v0));
+		const SimdFloat sz = SimdFloat::LoadAligned(rays.oz) - SimdFloat(getZComponent(v0));
+		const SimdFloat u = MulAdd(sx, px, MulAdd(sy, py, sz * pz)) * invDet;
+
+		const SimdFloat qx = sy * e1z - sz * e1y;
+		const SimdFloat qy = sz * e1x - sx * e1z;
+		const SimdFloat qz = sx * e1y - sy * e1x;
+		const SimdFloat v = MulAdd(dx, qx, MulAdd(dy, qy, dz * qz)) * invDet;
+		const SimdFloat t = MulAdd(e2x, qx, MulAdd(e2y, qy, e2z * qz)) * invDet;
+
+		const SimdFloat zero = SimdFloat::Zero();
+		SimdFloat hit = CmpGt(Abs(det), zero);
+		hit = And(hit, CmpGe(u, zero));
+		hit = And(hit, CmpGe(v, zero));
+		hit = And(hit, CmpLe(u + v, SimdFloat(1.0f)));
+		hit = And(hit, CmpGt(t, zero));
+		hit = And(hit, CmpLt(t, SimdFloat::LoadAligned(hits.t)));
+
+		const int laneMask = MoveMask(hit);
+		if (laneMask != 0) CommitHits(hits, laneMask, t, u, v, primitive);
+		return laneMask;
+	}
+
+	inline int IntersectPacketSphere(const RayPacket& rays, const Vector3& center, float radius,
+									 uint32_t primitive, HitPacket& hits){
+		const SimdFloat dx = SimdFloat::LoadAligned(rays.dx);
+		const SimdFloat dy = SimdFloat::LoadAligned(rays.dy);
+		const SimdFloat dz = SimdFloat::LoadAligned(rays.dz);
+		const SimdFloat ocx = SimdFloat::LoadAligned(rays.ox) - SimdFloat(getXComponent(center));
+		const SimdFloat ocy = SimdFloat::LoadAligned(rays.oy) - SimdFloat(getYComponent(center));
+		const SimdFloat ocz = SimdFloat::LoadAligned(rays.oz) - SimdFloat(getZComponent(center));
+
+		const SimdFloat a = MulAdd(dx, dx, MulAdd(dy, dy, dz * dz));
+		const SimdFloat b = MulAdd(ocx, dx, MulAdd(ocy, dy, ocz * dz));
+		const SimdFloat c = MulAdd(ocx, ocx, MulAdd(ocy, ocy, ocz * ocz)) - SimdFloat(SQR(radius));
+		const SimdFloat disc = b * b - a * c;
+
+		const SimdFloat root = Sqrt(Max(disc, SimdFloat::Zero()));
+		const SimdFloat invA = SimdFloat(1.0f) / a;
+		const SimdFloat tNear = (-b - root) * invA;
+		const SimdFloat tFar  = (-b + root) * invA;
+
+		// Rays starting inside the sphere report the exit point.
+		const SimdFloat t = Select(CmpGt(tNear, SimdFloat::Zero()), tNear, tFar);
+
+		SimdFloat hit = CmpGe(disc, SimdFloat::Zero());
+		hit = And(hit, CmpGt(t, SimdFloat::Zero()));
+		hit = And(hit, CmpLt(t, SimdFloat::LoadAligned(hits.t)));
+
+		const int laneMask = MoveMask(hit);
+		if (laneMask != 0) CommitHits(hits, laneMask, t, SimdFloat::Zero(), SimdFloat::Zero(), primitive);
+		return laneMask;
+	}
+
+	///	The plane is (normal, w) with dot(normal, p) + w == 0; both sides count as hits.
+	inline int IntersectPacketPlane(const RayPacket& rays, const Vector4& plane,
+									uint32_t primitive, HitPacket& hits){
+		const SimdFloat nx(getXComponent(plane));
+		const SimdFloat ny(getYComponent(plane));
+		const SimdFloat nz(getZComponent(plane));
+
+		const SimdFloat denom = MulAdd(nx, SimdFloat::LoadAligned(rays.dx),
+								MulAdd(ny, SimdFloat::LoadAligned(rays.dy), nz * SimdFloat::LoadAligned(rays.dz)));
+		const SimdFloat dist  = MulAdd(nx, SimdFloat::LoadAligned(rays.ox),
+								MulAdd(ny, SimdFloat::LoadAligned(rays.oy),
+								MulAdd(nz, SimdFloat::LoadAligned(rays.oz), SimdFloat(getWComponent(plane)))));
+		const SimdFloat t = -dist / denom;
+
+		SimdFloat hit = CmpGt(Abs(denom), SimdFloat::Zero());
+		hit = And(hit, CmpGt(t, SimdFloat::Zero()));
+		hit = And(hit, CmpLt(t, SimdFloat::LoadAligned(hits.t)));
+
+		const int laneMask = MoveMask(hit);
+		if (laneMask != 0) CommitHits(hits, laneMask, t, SimdFloat::Zero(), SimdFloat::Zero(), primitive);
+		return laneMask;
+	}
+
+	///	Slab test. Writes entry/exit distances per lane and returns the overlap
+	///	mask; it does not touch HitPacket, since boxes are usually culling volumes.
+	inline int IntersectPacketAABB(const RayPacket& rays, const Vector3& boxMin, const Vector3& boxMax,
+								   const HitPacket& hits, float* tEntry, float* tExit){
+		const SimdFloat one(1.0f);
+		const SimdFloat invX = one / SimdFloat::LoadAligned(rays.dx);
+		const SimdFloat invY = one / SimdFloat::LoadAligned(rays.dy);
+		const SimdFloat invZ = one / SimdFloat::LoadAligned(rays.dz);
+		const SimdFloat ox = SimdFloat::LoadAligned(rays.ox);
+		const SimdFloat oy = SimdFloat::LoadAligned(rays.oy);
+		const SimdFloat oz = SimdFloat::LoadAligned(rays.oz);
+
+		const SimdFloat tx0 = (SimdFloat(getXComponent(boxMin)) - ox) * invX;
+		const SimdFloat tx1 = (SimdFloat(getXComponent(boxMax)) - ox) * invX;
+		const SimdFloat ty0 = (SimdFloat(getYComponent(boxMin)) - oy) * invY;
+		const SimdFloat ty1 = (SimdFloat(getYComponent(boxMax)) - oy) * invY;
+		const SimdFloat tz0 = (SimdFloat(getZComponent(boxMin)) - oz) * invZ;
+		const SimdFloat tz1 = (SimdFloat(getZComponent(boxMax)) - oz) * invZ;
+
+		const SimdFloat tNear = Max(Max(Min(tx0, tx1), Min(ty0, ty1)), Max(Min(tz0, tz1), SimdFloat::Zero()));
+		const SimdFloat tFar  = Min(Min(Max(tx0, tx1), Max(ty0, ty1)), Min(Max(tz0, tz1), SimdFloat::LoadAligned(hits.t)));
+
+		tNear.Store(tEntry);
+		tFar.Store(tExit);
+		return MoveMask(CmpLe(tNear, tFar));
+	}
+	///
+	///	Packet kernels end
+	///
+
+	///
+	///	Wide kernel: one ray against RAY_PACKET_WIDTH triangles at a time
+	///
+	inline bool IntersectRayTriangles(const Vector3& origin, const Vector3& direction,
+									  const TriangleSoA& tris, float tMax, RayHit& hit){
+		const SimdFloat dx(getXComponent(direction)), dy(getYComponent(direction)), dz(getZComponent(direction));
+		const SimdFloat ox(getXComponent(origin)),	  oy(getYComponent(origin)),	oz(getZComponent(origin));
+		const SimdFloat zero = SimdFloat::Zero();
+		const SimdFloat one(1.0f);
+
+		hit.t = tMax;
+		hit.u = hit.v = 0.0f;
+		hit.primitive = std::numeric_limits<uint32_t>::max();
+
+		alignas(32) float tl[RAY_PACKET_WIDTH], ul[RAY_PACKET_WIDTH], vl[RAY_PACKET_WIDTH];
+		const size_t padded = tris.m_v0[0].size();
+
+		for (size_t i = 0; i < padded; i += SimdFloat::Width){
+			const SimdFloat e1x = SimdFloat::Load(&tris.m_e1[0][i]);
+			const SimdFloat e1y = SimdFloat::Load(&tris.m_e1[1][i]);
+			const SimdFloat e1z = SimdFloat::Load(&tris.m_e1[2][i]);
+			const SimdFloat e2x = SimdFloat::Load(&tris.m_e2[0][i]);
+			const SimdFloat e2y = SimdFloat::Load(&tris.m_e2[1][i]);
+			const SimdFloat e2z = SimdFloat::Load(&tris.m_e2[2][i]);
+
+			const SimdFloat px = dy * e2z - dz * e2y;
+			const SimdFloat py = dz * e2x - dx * e2z;
+			const SimdFloat pz = dx * e2y - dy * e2x;
+			const SimdFloat det = MulAdd(e1x, px, MulAdd(e1y, py, e1z * pz));
+			const SimdFloat invDet = one / det;
+
+			const SimdFloat sx = ox - SimdFloat::Load(&tris.m_v0[0][i]);
+			const SimdFloat sy = oy - SimdFloat::Load(&tris.m_v0[1][i]);
+			const SimdFloat sz = oz - SimdFloat::Load(&tris.m_v0[2][i]);
+			const SimdFloat u = MulAdd(sx, px, MulAdd(sy, py, sz * pz)) * invDet;
+
+			const SimdFloat qx = sy * e1z - sz * e1y;
+			const SimdFloat qy = sz * e1x - sx * e1z;
+			const SimdFloat qz = sx * e1y - sy * e1x;
+			const SimdFloat v = MulAdd(dx, qx, MulAdd(dy, qy, dz * qz)) * invDet;
+			const SimdFloat t = MulAdd(e2x, qx, MulAdd(e2y, qy, e2z * qz)) * invDet;
+
+			SimdFloat mask = CmpGt(Abs(det), zero);
+			mask = And(mask, CmpGe(u, zero));
+			mask = And(mask, CmpGe(v, zero));
+			mask = And(mask, CmpLe(u + v, one));
+			mask = And(mask, CmpGt(t, zero));
+			mask = And(mask, CmpLt(t, SimdFloat(hit.t)));
+
+			int laneMask = MoveMask(mask);
+			if (laneMask == 0) continue;
+
+			t.StoreAligned(tl);
+			u.StoreAligned(ul);
+			v.StoreAligned(vl);
+			for (size_t lane = 0; laneMask != 0; ++lane, laneMask >>= 1){
+				if ((laneMask & 1) && tl[lane] < hit.t){
+					hit.t = tl[lane];
+					hit.u = ul[lane];
+					hit.v = vl[lane];
+					hit.primitive = static_cast<uint32_t>(i + lane);
+				}
+			}
+		}
+		return hit.primitive != std::numeric_limits<uint32_t>::max();
+	}
+	///
+	///	Wide kernel end
+	///
+};
+
+#endif // FGML_INTERSECTION_HPP_
\ No newline at end of file
@@ -0,0 +1,534 @@
+#ifndef FGML_KDTREE_HPP_
+#define FGML_KDTREE_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Views.hpp"
+
+namespace FGML {
+	///
+	///	KDTree build internals
+	///
+	///	Points per chunk when one node's split runs across workers.
+	const size_t KDTREE_SPLIT_CHUNK = 65536;
+
+	///	Per-axis extent of the points perm[lo, hi) into minV[0..2] and maxV[0..2].
+	inline void KDTreeExtentRange(const float* const (&axisData)[3], const uint32_t* perm, size_t lo, size_t hi,
+								  float* minV, float* maxV){
+		for (size_t a = 0; a < 3; ++a){
+			const float* data = axisData[a];
+			float low = std::numeric_limits<float>::max(), high = -std::numeric_limits<float>::max();
+			for (size_t i = lo; i < hi; ++i){
+				const float v = data[perm[i]];
+				low	 = MIN(low, v);
+				high = MAX(high, v);
+			}
+			minV[a] = low;
+			maxV[a] = high;
+		}
+	}
+
+	///	As above, reduced over chunks in parallel.
+	inline void KDTreeExtent(const float* const (&axisData)[3], const uint32_t* perm, size_t lo, size_t hi,
+							 float (&minV)[3], float (&maxV)[3], size_t threadCount){
+		const size_t chunks = ChunkCount(hi - lo, KDTREE_SPLIT_CHUNK, threadCount);
+		if (chunks == 1){
+			KDTreeExtentRange(axisData, perm, lo, hi, minV, maxV);
+			return;
+		}
+
+		std::vector<float> partial(chunks * 6);
+		ParallelFor(hi - lo, KDTREE_SPLIT_CHUNK, [&](size_t begin, size_t end, size_t c){
+			KDTreeExtentRange(axisData, perm, lo + begin, lo + end, &partial[c * 6], &partial[c * 6 + 3]);
+		}, threadCount);
+
+		for (size_t a = 0; a < 3; ++a){
+			minV[a] = partial[a];
+			maxV[a] = partial[a + 3];
+			for (size_t c = 1; c < chunks; ++c){
+				minV[a] = MIN(minV[a], partial[c * 6 + a]);
+				maxV[a] = MAX(maxV[a], partial[c * 6 + a + 3]);
+			}
+		}
+	}
+
+	///	std::nth_element over perm[lo, hi) by data, placing rank mid. While
+	///	the range spans several chunks, each round three-way partitions it in
+	///	parallel around a sampled pivot (per-chunk counts, a band-major scan
+	///	and a stable scatter through scratch, as in RadixSortPairs) and keeps
+	///	the band holding mid.
+	inline void KDTreeSelect(const float* data, uint32_t* perm, uint32_t* scratch,
+							 size_t lo, size_t hi, size_t mid, size_t threadCount){
+		const size_t sampleCount = 63;
+		while (ChunkCount(hi - lo, KDTREE_SPLIT_CHUNK, threadCount) > 1){
+			const size_t n = hi - lo;
+
+			// Pivot: the evenly spaced sample at mid's relative rank.
+			float sample[sampleCount];
+			for (size_t k = 0; k < sampleCount; ++k) sample[k] = data[perm[lo + (2 * k + 1) * n / (2 * sampleCount)]];
+			const size_t rank = (mid - lo) * sampleCount / n;
+			std::nth_element(sample, sample + rank, sample + sampleCount);
+			const float pivot = sample[rank];
+
+			const size_t chunks = ChunkCount(n, KDTREE_SPLIT_CHUNK, threadCount);
+			std::vector<size_t> offsets(chunks * 3);
+			ParallelFor(n, KDTREE_SPLIT_CHUNK, [&](size_t begin, size_t end, size_t c){
+				size_t less = 0, equal = 0;
+				for (size_t i = lo + begin; i < lo + end; ++i){
+					const float v = data[perm[i]];
+					less  += (v < pivot)  ? 1 : 0;
+					equal += (v == pivot) ? 1 : 0;
+				}
+				offsets[c * 3]	   = less;
+				offsets[c * 3 + 1] = equal;
+				offsets[c * 3 + 2] = (end - begin) - less - equal;
+			}, threadCount);
+
+			size_t bandStart[3];
+			size_t running = lo;
+			for (size_t band = 0; band < 3; ++band){
+				bandStart[band] = running;
+				for (size_t c = 0; c < chunks; ++c){
+					const size_t count = offsets[c * 3 + band];
+					offsets[c * 3 + band] = running;
+					running += count;
+				}
+			}
+
+			ParallelFor(n, KDTREE_SPLIT_CHUNK, [&](size_t begin, size_t end, size_t c){
+				size_t* offset = &offsets[c * 3];
+				for (size_t i = lo + begin; i < lo + end; ++i){
+					const uint32_t p = perm[i];
+					const float v = data[p];
+					scratch[offset[(v < pivot) ? 0 : ((v == pivot) ? 1 : 2)]++] = p;
+				}
+			}, threadCount);
+			ParallelFor(n, KDTREE_SPLIT_CHUNK, [&](size_t begin, size_t end, size_t){
+				std::copy(scratch + lo + begin, scratch + lo + end, perm + lo + begin);
+			}, threadCount);
+
+			// The pivot band is never empty, so the range shrinks every round.
+			if (mid < bandStart[1]) hi = bandStart[1];
+			else if (mid < bandStart[2]) return;
+			else lo = bandStart[2];
+		}
+
+		std::nth_element(perm + lo, perm + mid, perm + hi, [data](uint32_t a, uint32_t b){ return data[a] < data[b]; });
+	}
+	///
+	///	KDTree build internals end
+	///
+
+	///
+	///	Definition of KDTree class
+	///
+	///	Balanced median-split tree over a static Vector3 set. Internal nodes
+	///	live in implicit heap order (children of i are 2i + 1 and 2i + 2), so a
+	///	node is just a split value and an axis. Leaves hold their points in
+	///	SoA padded to the SIMD width, which lets leaf scans run without tails.
+	///
+	class KDTree {
+	private:
+		struct StackEntry {
+			uint32_t node;
+			float	 planeDistSq;
+		};
+
+		size_t					m_leafSize;
+		size_t					m_depth;
+		size_t					m_internalCount;
+		size_t					m_count;
+
+		std::vector<float>		m_splitValue;
+		std::vector<uint8_t>	m_splitAxis;
+		std::vector<uint32_t>	m_leafStart;
+		std::vector<float>		m_x;
+		std::vector<float>		m_y;
+		std::vector<float>		m_z;
+		std::vector<uint32_t>	m_index;
+
+		inline uint32_t HomeLeaf(float qx, float qy, float qz) const;
+		inline bool		NearestImpl(float qx, float qy, float qz, uint32_t& outIndex, float& outDistSq) const;
+		inline void		KNearestImpl(float qx, float qy, float qz, size_t k,
+									 std::vector<std::pair<float, uint32_t>>& heap) const;
+		inline void		CoherentOrder(ConstVec3ArrayView queries, std::vector<uint32_t>& order) const;
+	public:
+		explicit KDTree(size_t leafSize = 16);
+
+		inline void Build(ConstVec3ArrayView points, size_t threadCount = 0);
+		inline void Build(const Vector3* points, size_t count, size_t threadCount = 0);
+
+		inline bool   Nearest(const Vector3& query, uint32_t& outIndex, float& outDistSq) const;
+		inline size_t KNearest(const Vector3& query, size_t k, uint32_t* outIndices, float* outDistSq) const;
+
+		inline void NearestBatch(ConstVec3ArrayView queries,
+								 uint32_t* outIndices, float* outDistSq, size_t threadCount = 0) const;
+		inline void NearestBatch(const Vector3* queries, size_t count,
+								 uint32_t* outIndices, float* outDistSq, size_t threadCount = 0) const;
+		inline void KNearestBatch(ConstVec3ArrayView queries, size_t k,
+								  uint32_t* outIndices, float* outDistSq, size_t threadCount = 0) const;
+		inline void KNearestBatch(const Vector3* queries, size_t count, size_t k,
+								  uint32_t* outIndices, float* outDistSq, size_t threadCount = 0) const;
+
+		inline size_t Size(void) const;
+
+		~KDTree() = default;
+	};
+	///
+	///	Definition of KDTree class end
+	///
+
+	///
+	///	Declaration of KDTree methods
+	///
+	inline KDTree::KDTree(size_t leafSize)
+	: m_leafSize(MAX(leafSize, SimdFloat::Width)), m_depth(0), m_internalCount(0), m_count(0) {}
+
+	inline void KDTree::Build(ConstVec3ArrayView points, size_t threadCount){
+		FGML_SCOPED_TIMER(KDTreeBuild);
+		const size_t count = points.size();
+		assert(count < std::numeric_limits<uint32_t>::max() && "Too many points for 32-bit indices");
+
+		this->m_count = count;
+		this->m_depth = 0;
+		while ((count >> this->m_depth) > this->m_leafSize) ++this->m_depth;
+		assert(this->m_depth < 32 && "Tree too deep for the traversal stack");
+
+		this->m_internalCount = (size_t(1) << this->m_depth) - 1;
+		const size_t leafCount = this->m_internalCount + 1;
+
+		this->m_splitValue.assign(this->m_internalCount, 0.0f);
+		this->m_splitAxis.assign(this->m_internalCount, 0);
+
+		std::vector<uint32_t> perm(count);
+		for (size_t i = 0; i < count; ++i) perm[i] = static_cast<uint32_t>(i);
+
+		// Build on SoA copies so the partitioning comparator is a single indexed load.
+		std::vector<float> px(count), py(count), pz(count);
+		ParallelFor(count, 65536, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i){
+				px[i] = points.X(i);
+				py[i] = points.Y(i);
+				pz[i] = points.Z(i);
+			}
+		}, threadCount);
+		const float* axisData[3] = { px.data(), py.data(), pz.data() };
+
+		// Node n at a level owns perm[begin[n], begin[n + 1]); halving keeps the tree balanced.
+		std::vector<size_t> bounds(2);
+		bounds[0] = 0;
+		bounds[1] = count;
+
+		std::vector<uint32_t> scratch;
+
+		// Splits node n of the level starting at first, using nodeThreads workers inside it.
+		auto splitNode = [&](size_t first, size_t n, std::vector<size_t>& next, size_t nodeThreads){
+			const size_t lo = bounds[n], hi = bounds[n + 1];
+			const size_t mid = lo + (hi - lo) / 2;
+			next[2 * n]		= lo;
+			next[2 * n + 1] = mid;
+
+			if (hi == lo){
+				this->m_splitAxis[first + n]  = 0;
+				this->m_splitValue[first + n] = 0.0f;
+				return;
+			}
+
+			float minV[3], maxV[3];
+			KDTreeExtent(axisData, perm.data(), lo, hi, minV, maxV, nodeThreads);
+
+			uint8_t axis = 0;
+			for (uint8_t a = 1; a < 3; ++a){
+				if (maxV[a] - minV[a] > maxV[axis] - minV[axis]) axis = a;
+			}
+
+			const float* data = axisData[axis];
+			KDTreeSelect(data, perm.data(), scratch.data(), lo, hi, mid, nodeThreads);
+
+			this->m_splitAxis[first + n]  = axis;
+			this->m_splitValue[first + n] = data[perm[mid]];
+		};
+
+		// The top levels have fewer nodes than workers, so each of their
+		// nodes is split by all workers in turn; below that, one node per task.
+		const size_t workers = (threadCount == 0) ? HardwareThreads() : threadCount;
+
+		for (size_t level = 0; level < this->m_depth; ++level){
+			const size_t nodes = size_t(1) << level;
+			const size_t first = nodes - 1;
+			std::vector<size_t> next(2 * nodes + 1);
+
+			if (nodes < workers && count / nodes > KDTREE_SPLIT_CHUNK){
+				scratch.resize(count);
+				for (size_t n = 0; n < nodes; ++n) splitNode(first, n, next, threadCount);
+			}
+			else {
+				ParallelFor(nodes, 1, [&](size_t nodeBegin, size_t nodeEnd, size_t){
+					for (size_t n = nodeBegin; n < nodeEnd; ++n) splitNode(first, n, next, 1);
+				}, threadCount);
+			}
+
+			next[2 * nodes] = count;
+			bounds.swap(next);
+		}
+
+		// Lay leaves out in SoA, each padded with +inf points to a multiple of the SIMD width.
+		this->m_leafStart.resize(leafCount + 1);
+		this->m_leafStart[0] = 0;
+		for (size_t l = 0; l < leafCount; ++l){
+			const size_t used	= bounds[l + 1] - bounds[l];
+			const size_t padded = (used + SimdFloat::Width - 1) / SimdFloat::Width * SimdFloat::Width;
+			this->m_leafStart[l + 1] = this->m_leafStart[l] + static_cast<uint32_t>(padded);
+		}
+
+		const size_t total = this->m_leafStart[leafCount];
+		const float inf = std::numeric_limits<float>::infinity();
+		this->m_x.assign(total, inf);
+		this->m_y.assign(total, inf);
+		this->m_z.assign(total, inf);
+		this->m_index.assign(total, std::numeric_limits<uint32_t>::max());
+
+		ParallelFor(leafCount, 64, [&](size_t leafBegin, size_t leafEnd, size_t){
+			for (size_t l = leafBegin; l < leafEnd; ++l){
+				size_t slot = this->m_leafStart[l];
+				for (size_t i = bounds[l]; i < bounds[l + 1]; ++i, ++slot){
+					const uint32_t p = perm[i];
+					this->m_x[slot]		= px[p];
+					this->m_y[slot]		= py[p];
+					this->m_z[slot]		= pz[p];
+					this->m_index[slot] = p;
+				}
+			}
+		}, threadCount);
+	}
+
+	inline uint32_t KDTree::HomeLeaf(float qx, float qy, float qz) const {
+		const float q[3] = { qx, qy, qz };
+		size_t node = 0;
+		while (node < this->m_internalCount){
+			const bool right = q[this->m_splitAxis[node]] >= this->m_splitValue[node];
+			node = 2 * node + 1 + (right ? 1 : 0);
+		}
+		return static_cast<uint32_t>(node - this->m_internalCount);
+	}
+
+	inline bool KDTree::NearestImpl(float qx, float qy, float qz, uint32_t& outIndex, float& outDistSq) const {
+		if (this->m_count == 0) return false;
+
+		const float q[3] = { qx, qy, qz };
+		const SimdFloat vx(qx), vy(qy), vz(qz);
+		float bestSq = std::numeric_limits<float>::infinity();
+		uint32_t best = std::numeric_limits<uint32_t>::max();
+
+		StackEntry stack[64];
+		size_t top = 0;
+		stack[top++] = StackEntry{ 0, 0.0f };
+
+		while (top > 0){
+			const StackEntry entry = stack[--top];
+			if (entry.planeDistSq >= bestSq) continue;
+
+			size_t node = entry.node;
+			while (node < this->m_internalCount){
+				const float diff = q[this->m_splitAxis[node]] - this->m_splitValue[node];
+				const size_t nearChild = 2 * node + 1 + ((diff >= 0.0f) ? 1 : 0);
+				const size_t farChild  = (nearChild & 1) ? nearChild + 1 : nearChild - 1;
+				stack[top++] = StackEntry{ static_cast<uint32_t>(farChild), SQR(diff) };
+				node = nearChild;
+			}
+
+			const size_t leaf = node - this->m_internalCount;
+			alignas(32) float lanes[SimdFloat::Width];
+			for (uint32_t s = this->m_leafStart[leaf]; s < this->m_leafStart[leaf + 1]; s += SimdFloat::Width){
+				const SimdFloat dx = SimdFloat::Load(&this->m_x[s]) - vx;
+				const SimdFloat dy = SimdFloat::Load(&this->m_y[s]) - vy;
+				const SimdFloat dz = SimdFloat::Load(&this->m_z[s]) - vz;
+				const SimdFloat distSq = MulAdd(dx, dx, MulAdd(dy, dy, dz * dz));
+
+				int mask = MoveMask(CmpLt(distSq, SimdFloat(bestSq)));
+				if (mask == 0) continue;
+
+				distSq.StoreAligned(lanes);
+				for (size_t lane = 0; mask != 0; ++lane, mask >>= 1){
+					if ((mask & 1) && lanes[lane] < bestSq){
+						bestSq = lanes[lane];
+						best   = this->m_index[s + lane];
+					}
+				}
+			}
+		}
+
+		outIndex  = best;
+		outDistSq = bestSq;
+		return best != std::numeric_limits<uint32_t>::max();
+	}
+
+	inline void KDTree::KNearestImpl(float qx, float qy, float qz, size_t k,
+									 std::vector<std::pair<float, uint32_t>>& heap) const {
+		heap.clear();
+		if (this->m_count == 0 || k == 0) return;
+
+		const float q[3] = { qx, qy, qz };
+		const SimdFloat vx(qx), vy(qy), vz(qz);
+		const float inf = std::numeric_limits<float>::infinity();
+
+		StackEntry stack[64];
+		size_t top = 0;
+		stack[top++] = StackEntry{ 0, 0.0f };
+
+		while (top > 0){
+			const StackEntry entry = stack[--top];
+			const float worst = (heap.size() == k) ? heap.front().first : inf;
+			if (entry.planeDistSq >= worst) continue;
+
+			size_t node = entry.node;
+			while (node < this->m_internalCount){
+				const float diff = q[this->m_splitAxis[node]] - this->m_splitValue[node];
+				const size_t nearChild = 2 * node + 1 + ((diff >= 0.0f) ? 1 : 0);
+				const size_t farChild  = (nearChild & 1) ? nearChild + 1 : nearChild - 1;
+				stack[top++] = StackEntry{ static_cast<uint32_t>(farChild), SQR(diff) };
+				node = nearChild;
+			}
+
+			const size_t leaf = node - this->m_internalCount;
+			alignas(32) float lanes[SimdFloat::Width];
+			for (uint32_t s = this->m_leafStart[leaf]; s < this->m_leafStart[leaf + 1]; s += SimdFloat::Width){
+				const SimdFloat dx = SimdFloat::Load(&this->m_x[s]) - vx;
+				const SimdFloat dy = SimdFloat::Load(&this->m_y[s]) - vy;
+				const SimdFloat dz = SimdFloat::Load(&this->m_z[s]) - vz;
+				const SimdFloat distSq = MulAdd(dx, dx, MulAdd(dy, dy, dz * dz));
+
+				const float limit = (heap.size() == k) ? heap.front().first : inf;
+				int mask = MoveMask(CmpLt(distSq, SimdFloat(limit)));
+				if (mask == 0) continue;
+
+				distSq.StoreAligned(lanes);
+				for (size_t lane = 0; mask != 0; ++lane, mask >>= 1){
+					if (!(mask & 1)) continue;
+					if (heap.size() == k){
+						if (lanes[lane] >= heap.front().first) continue;
+						std::pop_heap(heap.begin(), heap.end());
+						heap.pop_back();
+					}
+					heap.push_back(std::make_pair(lanes[lane], this->m_index[s + lane]));
+					std::push_heap(heap.begin(), heap.end());
+				}
+			}
+		}
+
+		std::sort_heap(heap.begin(), heap.end());
+	}
+
+	///	Orders queries by the leaf they land in, so consecutive queries share tree paths and leaf data.
+	inline void KDTree::CoherentOrder(ConstVec3ArrayView queries, std::vector<uint32_t>& order) const {
+		const size_t count = queries.size();
+		const size_t leafCount = this->m_internalCount + 1;
+		std::vector<uint32_t> homeLeaf(count);
+		std::vector<uint32_t> start(leafCount + 1, 0);
+
+		for (size_t q = 0; q < count; ++q){
+			homeLeaf[q] = this->HomeLeaf(queries.X(q), queries.Y(q), queries.Z(q));
+			++start[homeLeaf[q] + 1];
+		}
+		for (size_t l = 0; l < leafCount; ++l) start[l + 1] += start[l];
+
+		order.resize(count);
+		for (size_t q = 0; q < count; ++q) order[start[homeLeaf[q]]++] = static_cast<uint32_t>(q);
+	}
+
+	inline bool KDTree::Nearest(const Vector3& query, uint32_t& outIndex, float& outDistSq) const {
+		return this->NearestImpl(getXComponent(query), getYComponent(query), getZComponent(query), outIndex, outDistSq);
+	}
+
+	///	Writes up to k neighbours, nearest first; returns how many were found.
+	inline size_t KDTree::KNearest(const Vector3& query, size_t k, uint32_t* outIndices, float* outDistSq) const {
+		std::vector<std::pair<float, uint32_t>> heap;
+		heap.reserve(k);
+		this->KNearestImpl(getXComponent(query), getYComponent(query), getZComponent(query), k, heap);
+
+		for (size_t i = 0; i < heap.size(); ++i){
+			outDistSq[i]  = heap[i].first;
+			outIndices[i] = heap[i].second;
+		}
+		return heap.size();
+	}
+
+	///	Empty trees yield UINT32_MAX and +infinity.
+	inline void KDTree::NearestBatch(ConstVec3ArrayView queries,
+									 uint32_t* outIndices, float* outDistSq, size_t threadCount) const {
+		FGML_SCOPED_TIMER(KDTreeNearestBatch);
+
+		std::vector<uint32_t> order;
+		this->CoherentOrder(queries, order);
+
+		ParallelFor(queries.size(), 256, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i){
+				const uint32_t q = order[i];
+				if (!this->NearestImpl(queries.X(q), queries.Y(q), queries.Z(q), outIndices[q], outDistSq[q])){
+					outIndices[q] = std::numeric_limits<uint32_t>::max();
+					outDistSq[q]  = std::numeric_limits<float>::infinity();
+				}
+			}
+		}, threadCount);
+	}
+
+	///	Each query owns k output slots; unused slots get UINT32_MAX and +infinity.
+	inline void KDTree::KNearestBatch(ConstVec3ArrayView queries, size_t k,
+									  uint32_t* outIndices, float* outDistSq, size_t threadCount) const {
+		FGML_SCOPED_TIMER(KDTreeKNearestBatch);
+
+		std::vector<uint32_t> order;
+		this->CoherentOrder(queries, order);
+
+		ParallelFor(queries.size(), 256, [&](size_t begin, size_t end, size_t){
+			std::vector<std::pair<float, uint32_t>> heap;
+			heap.reserve(k);
+
+			for (size_t i = begin; i < end; ++i){
+				const uint32_t q = order[i];
+				this->KNearestImpl(queries.X(q), queries.Y(q), queries.Z(q), k, heap);
+
+				uint32_t* idx = outIndices + q * k;
+				float*	  dst = outDistSq  + q * k;
+				for (size_t j = 0; j < k; ++j){
+					idx[j] = (j < heap.size()) ? heap[j].second : std::numeric_limits<uint32_t>::max();
+					dst[j] = (j < heap.size()) ? heap[j].first	: std::numeric_limits<float>::infinity();
+				}
+			}
+		}, threadCount);
+	}
+
+	inline void KDTree::Build(const Vector3* points, size_t count, size_t threadCount){
+		this->Build(ConstVec3ArrayView(points, count), threadCount);
+	}
+
+	inline void KDTree::NearestBatch(const Vector3* queries, size_t count,
+									 uint32_t* outIndices, float* outDistSq, size_t threadCount) const {
+		this->NearestBatch(ConstVec3ArrayView(queries, count), outIndices, outDistSq, threadCount);
+	}
+
+	inline void KDTree::KNearestBatch(const Vector3* queries, size_t count, size_t k,
+									  uint32_t* outIndices, float* outDistSq, size_t threadCount) const {
+		this->KNearestBatch(ConstVec3ArrayView(queries, count), k, outIndices, outDistSq, threadCount);
+	}
+
+	inline size_t KDTree::Size(void) const {
+		return this->m_count;
+	}
+	///
+	///	Declaration of KDTree methods end
+	///
+};
+
+#endif // FGML_KDTREE_HPP_
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Vector3.hpp"
+#include "Instrument.hpp"
 #include <cassert>
 #include <cstddef>
 
@@ -51,6 +52,12 @@ namespace FGML {
 
 		inline Vector3 operator[](const size_t& rowNumber);
 
+		inline float*		data(void);
+		inline const float* data(void) const;
+
+		friend inline float	  getElement(const Matrix3x3& mat, const size_t& row, const size_t& column);
+		friend inline Vector3 getColumn(const Matrix3x3& mat, const size_t& column);
+
 		~Matrix3x3() = default;
 
 		friend std::ostream& operator<<(std::ostream& out, Matrix3x3 m);
@@ -152,6 +159,7 @@ namespace FGML {
 	}
 
 	inline Matrix3x3 operator*(const Matrix3x3& mat1, const Matrix3x3& mat2){
+		FGML_PROBE(Mat3Mul);
 		return Matrix3x3( mat1.m_arr[0][0] * mat2.m_arr[0][0] + mat1.m_arr[0][1] * mat2.m_arr[1][0] + mat1.m_arr[0][2] * mat2.m_arr[2][0],
 						  mat1.m_arr[0][0] * mat2.m_arr[0][1] + mat1.m_arr[0][1] * mat2.m_arr[1][1] + mat1.m_arr[0][2] * mat2.m_arr[2][1],
 						  mat1.m_arr[0][0] * mat2.m_arr[0][2] + mat1.m_arr[0][1] * mat2.m_arr[1][2] + mat1.m_arr[0][2] * mat2.m_arr[2][2],
@@ -166,6 +174,7 @@ namespace FGML {
 	}
 
 	inline Vector3   operator*(const Matrix3x3& mat,  const Vector3& vec){
+		FGML_PROBE(Mat3MulVec);
 		return   Vector3( mat.m_arr[0][0] * getXComponent(vec) + mat.m_arr[0][1] * getYComponent(vec) + mat.m_arr[0][2] * getZComponent(vec),
 						  mat.m_arr[1][0] * getXComponent(vec) + mat.m_arr[1][1] * getYComponent(vec) + mat.m_arr[1][2] * getZComponent(vec),
 						  mat.m_arr[2][0] * getXComponent(vec) + mat.m_arr[2][1] * getYComponent(vec) + mat.m_arr[2][2] * getZComponent(vec) );
@@ -197,12 +206,14 @@ namespace FGML {
 	}
 
 	inline float Matrix3x3::Determinant(void){
+		FGML_PROBE(Mat3Determinant);
 		return (this->m_arr[0][0] * (this->m_arr[1][1] * this->m_arr[2][2] - this->m_arr[1][2] * this->m_arr[2][1])
 				- this->m_arr[0][1] * (this->m_arr[1][0] * this->m_arr[2][2] - this->m_arr[1][2] * this->m_arr[2][0])
 				+ this->m_arr[0][2] * (this->m_arr[1][0] * this->m_arr[2][1] - this->m_arr[1][1] * this->m_arr[2][0]));
 	}
 
 	inline float Determinant(const Matrix3x3& mat){
+		FGML_PROBE(Mat3Determinant);
 		return (mat.m_arr[0][0] * (mat.m_arr[1][1] * mat.m_arr[2][2] - mat.m_arr[1][2] * mat.m_arr[2][1])
 				- mat.m_arr[0][1] * (mat.m_arr[1][0] * mat.m_arr[2][2] - mat.m_arr[1][2] * mat.m_arr[2][0])
 				+ mat.m_arr[0][2] * (mat.m_arr[1][0] * mat.m_arr[2][1] - mat.m_arr[1][1] * mat.m_arr[2][0]));
@@ -214,6 +225,19 @@ namespace FGML {
 		return Vector3(m_arr[rowNumber][0], m_arr[rowNumber][1], m_arr[rowNumber][2]);
 	}
 
+	inline float*		Matrix3x3::data(void)		 { return &this->m_arr[0][0]; }
+	inline const float* Matrix3x3::data(void) const { return &this->m_arr[0][0]; }
+
+	inline float   getElement(const Matrix3x3& mat, const size_t& row, const size_t& column){
+		assert(row < 3uL && column < 3uL && "Going beyond the matrix!");
+		return mat.m_arr[row][column];
+	}
+
+	inline Vector3 getColumn(const Matrix3x3& mat, const size_t& column){
+		assert(column < 3uL && "Going beyond the matrix!");
+		return Vector3(mat.m_arr[0][column], mat.m_arr[1][column], mat.m_arr[2][column]);
+	}
+
 	std::ostream& operator<<(std::ostream& out, Matrix3x3 m){
 		std::cout << m.m_arr[0][0] << " | " << m.m_arr[0][1] << " | " << m.m_arr[0][2] << std::endl;
 		std::cout << m.m_arr[1][0] << " | " << m.m_arr[1][1] << " | " << m.m_arr[1][2] << std::endl;
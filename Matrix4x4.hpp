@@ -1,10 +1,11 @@
 #include <cstddef>
 #include <cassert>
 #include "Vector4.hpp"
+#include "Instrument.hpp"
 
 #include <iostream>
 
-#ifndef FGML_MATRIX4x4_HPP_
+#ifndef FGML_MATRIX4X4_HPP_
 #define FGML_MATRIX4X4_HPP_
 
 namespace FGML {
@@ -52,6 +53,12 @@ namespace FGML {
 
 		inline Vector4 operator[](size_t rowNumber);
 
+		inline float*		data(void);
+		inline const float* data(void) const;
+
+		friend inline float	  getElement(const Matrix4x4& mat, const size_t& row, const size_t& column);
+		friend inline Vector4 getColumn(const Matrix4x4& mat, const size_t& column);
+
 		~Matrix4x4() = default;
 
 		friend std::ostream& operator<<(std::ostream& out, Matrix4x4 m);
@@ -176,28 +183,30 @@ namespace FGML {
 	}
 
 	inline Matrix4x4 operator*(const Matrix4x4& mat1, const Matrix4x4& mat2){
-		return Matrix4x4( mat1.m_arr[0][0] * mat2.m_arr[0][0] + mat1.m_arr[0][1] * mat2.m_arr[1][0] + mat1.m_arr[0][2] * mat2.m_arr[2][0],
-						  mat1.m_arr[0][0] * mat2.m_arr[0][1] + mat1.m_arr[0][1] * mat2.m_arr[1][1] + mat1.m_arr[0][2] * mat2.m_arr[2][1],
-						  mat1.m_arr[0][0] * mat2.m_arr[0][2] + mat1.m_arr[0][1] * mat2.m_arr[1][2] + mat1.m_arr[0][2] * mat2.m_arr[2][2],
-						  mat1.m_arr[0][0] * mat2.m_arr[0][3] + mat1.m_arr[0][1] * mat2.m_arr[1][3] + mat1.m_arr[0][2] * mat2.m_arr[2][3],
-
-						  mat1.m_arr[1][0] * mat2.m_arr[0][0] + mat1.m_arr[1][1] * mat2.m_arr[1][0] + mat1.m_arr[1][2] * mat2.m_arr[2][0],
-						  mat1.m_arr[1][0] * mat2.m_arr[0][1] + mat1.m_arr[1][1] * mat2.m_arr[1][1] + mat1.m_arr[1][2] * mat2.m_arr[2][1],
-						  mat1.m_arr[1][0] * mat2.m_arr[0][2] + mat1.m_arr[1][1] * mat2.m_arr[1][2] + mat1.m_arr[1][2] * mat2.m_arr[2][2],
-						  mat1.m_arr[1][0] * mat2.m_arr[0][3] + mat1.m_arr[1][1] * mat2.m_arr[1][3] + mat1.m_arr[1][2] * mat2.m_arr[2][3],
-
-						  mat1.m_arr[2][0] * mat2.m_arr[0][0] + mat1.m_arr[2][1] * mat2.m_arr[1][0] + mat1.m_arr[2][2] * mat2.m_arr[2][0],
-						  mat1.m_arr[2][0] * mat2.m_arr[0][1] + mat1.m_arr[2][1] * mat2.m_arr[1][1] + mat1.m_arr[2][2] * mat2.m_arr[2][1],
-						  mat1.m_arr[2][0] * mat2.m_arr[0][2] + mat1.m_arr[2][1] * mat2.m_arr[1][2] + mat1.m_arr[2][2] * mat2.m_arr[2][2],
-						  mat1.m_arr[2][0] * mat2.m_arr[0][3] + mat1.m_arr[2][1] * mat2.m_arr[1][3] + mat1.m_arr[2][2] * mat2.m_arr[2][3],
-
-						  mat1.m_arr[3][0] * mat2.m_arr[0][0] + mat1.m_arr[3][1] * mat2.m_arr[1][0] + mat1.m_arr[3][2] * mat2.m_arr[2][0],
-						  mat1.m_arr[3][0] * mat2.m_arr[0][1] + mat1.m_arr[3][1] * mat2.m_arr[1][1] + mat1.m_arr[3][2] * mat2.m_arr[2][1],
-						  mat1.m_arr[3][0] * mat2.m_arr[0][2] + mat1.m_arr[3][1] * mat2.m_arr[1][2] + mat1.m_arr[3][2] * mat2.m_arr[2][2],
-						  mat1.m_arr[3][0] * mat2.m_arr[0][3] + mat1.m_arr[3][1] * mat2.m_arr[1][3] + mat1.m_arr[3][2] * mat2.m_arr[2][3] );
+		FGML_PROBE(Mat4Mul);
+		return Matrix4x4( mat1.m_arr[0][0] * mat2.m_arr[0][0] + mat1.m_arr[0][1] * mat2.m_arr[1][0] + mat1.m_arr[0][2] * mat2.m_arr[2][0] + mat1.m_arr[0][3] * mat2.m_arr[3][0],
+						  mat1.m_arr[0][0] * mat2.m_arr[0][1] + mat1.m_arr[0][1] * mat2.m_arr[1][1] + mat1.m_arr[0][2] * mat2.m_arr[2][1] + mat1.m_arr[0][3] * mat2.m_arr[3][1],
+						  mat1.m_arr[0][0] * mat2.m_arr[0][2] + mat1.m_arr[0][1] * mat2.m_arr[1][2] + mat1.m_arr[0][2] * mat2.m_arr[2][2] + mat1.m_arr[0][3] * mat2.m_arr[3][2],
+						  mat1.m_arr[0][0] * mat2.m_arr[0][3] + mat1.m_arr[0][1] * mat2.m_arr[1][3] + mat1.m_arr[0][2] * mat2.m_arr[2][3] + mat1.m_arr[0][3] * mat2.m_arr[3][3],
+
+						  mat1.m_arr[1][0] * mat2.m_arr[0][0] + mat1.m_arr[1][1] * mat2.m_arr[1][0] + mat1.m_arr[1][2] * mat2.m_arr[2][0] + mat1.m_arr[1][3] * mat2.m_arr[3][0],
+						  mat1.m_arr[1][0] * mat2.m_arr[0][1] + mat1.m_arr[1][1] * mat2.m_arr[1][1] + mat1.m_arr[1][2] * mat2.m_arr[2][1] + mat1.m_arr[1][3] * mat2.m_arr[3][1],
+						  mat1.m_arr[1][0] * mat2.m_arr[0][2] + mat1.m_arr[1][1] * mat2.m_arr[1][2] + mat1.m_arr[1][2] * mat2.m_arr[2][2] + mat1.m_arr[1][3] * mat2.m_arr[3][2],
+						  mat1.m_arr[1][0] * mat2.m_arr[0][3] + mat1.m_arr[1][1] * mat2.m_arr[1][3] + mat1.m_arr[1][2] * mat2.m_arr[2][3] + mat1.m_arr[1][3] * mat2.m_arr[3][3],
+
+						  mat1.m_arr[2][0] * mat2.m_arr[0][0] + mat1.m_arr[2][1] * mat2.m_arr[1][0] + mat1.m_arr[2][2] * mat2.m_arr[2][0] + mat1.m_arr[2][3] * mat2.m_arr[3][0],
+						  mat1.m_arr[2][0] * mat2.m_arr[0][1] + mat1.m_arr[2][1] * mat2.m_arr[1][1] + mat1.m_arr[2][2] * mat2.m_arr[2][1] + mat1.m_arr[2][3] * mat2.m_arr[3][1],
+						  mat1.m_arr[2][0] * mat2.m_arr[0][2] + mat1.m_arr[2][1] * mat2.m_arr[1][2] + mat1.m_arr[2][2] * mat2.m_arr[2][2] + mat1.m_arr[2][3] * mat2.m_arr[3][2],
+						  mat1.m_arr[2][0] * mat2.m_arr[0][3] + mat1.m_arr[2][1] * mat2.m_arr[1][3] + mat1.m_arr[2][2] * mat2.m_arr[2][3] + mat1.m_arr[2][3] * mat2.m_arr[3][3],
+
+						  mat1.m_arr[3][0] * mat2.m_arr[0][0] + mat1.m_arr[3][1] * mat2.m_arr[1][0] + mat1.m_arr[3][2] * mat2.m_arr[2][0] + mat1.m_arr[3][3] * mat2.m_arr[3][0],
+						  mat1.m_arr[3][0] * mat2.m_arr[0][1] + mat1.m_arr[3][1] * mat2.m_arr[1][1] + mat1.m_arr[3][2] * mat2.m_arr[2][1] + mat1.m_arr[3][3] * mat2.m_arr[3][1],
+						  mat1.m_arr[3][0] * mat2.m_arr[0][2] + mat1.m_arr[3][1] * mat2.m_arr[1][2] + mat1.m_arr[3][2] * mat2.m_arr[2][2] + mat1.m_arr[3][3] * mat2.m_arr[3][2],
+						  mat1.m_arr[3][0] * mat2.m_arr[0][3] + mat1.m_arr[3][1] * mat2.m_arr[1][3] + mat1.m_arr[3][2] * mat2.m_arr[2][3] + mat1.m_arr[3][3] * mat2.m_arr[3][3] );
 	}
 
 	inline Vector4   operator*(const Matrix4x4& mat,  const Vector4& vec){
+		FGML_PROBE(Mat4MulVec);
 		return   Vector4( mat.m_arr[0][0] * getXComponent(vec) + mat.m_arr[0][1] * getYComponent(vec) + mat.m_arr[0][2] * getZComponent(vec) + mat.m_arr[0][3] * getWComponent(vec),
 						  mat.m_arr[1][0] * getXComponent(vec) + mat.m_arr[1][1] * getYComponent(vec) + mat.m_arr[1][2] * getZComponent(vec) + mat.m_arr[1][3] * getWComponent(vec),
 						  mat.m_arr[2][0] * getXComponent(vec) + mat.m_arr[2][1] * getYComponent(vec) + mat.m_arr[2][2] * getZComponent(vec) + mat.m_arr[2][3] * getWComponent(vec),
@@ -239,6 +248,19 @@ namespace FGML {
 		return Vector4(m_arr[i][0], m_arr[i][1], m_arr[i][2], m_arr[i][3]);
 	}
 
+	inline float*		Matrix4x4::data(void)		 { return &this->m_arr[0][0]; }
+	inline const float* Matrix4x4::data(void) const { return &this->m_arr[0][0]; }
+
+	inline float   getElement(const Matrix4x4& mat, const size_t& row, const size_t& column){
+		assert(row < 4uL && column < 4uL && "Going beyond the matrix!");
+		return mat.m_arr[row][column];
+	}
+
+	inline Vector4 getColumn(const Matrix4x4& mat, const size_t& column){
+		assert(column < 4uL && "Going beyond the matrix!");
+		return Vector4(mat.m_arr[0][column], mat.m_arr[1][column], mat.m_arr[2][column], mat.m_arr[3][column]);
+	}
+
 	std::ostream& operator<<(std::ostream& out, Matrix4x4 m){
 		std::cout << m.m_arr[0][0] << " | " << m.m_arr[0][1] << " | " << m.m_arr[0][2] << " | " << m.m_arr[0][3] << std::endl;
 		std::cout << m.m_arr[1][0] << " | " << m.m_arr[1][1] << " | " << m.m_arr[1][2] << " | " << m.m_arr[1][3] << std::endl;
@@ -251,4 +273,4 @@ namespace FGML {
 	///
 };
 
-#endif // FGML_MATRIX4x4_HPP_
\ No newline at end of file
+#endif // FGML_MATRIX4X4_HPP_
\ No newline at end of file
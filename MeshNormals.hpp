@@ -0,0 +1,288 @@
+#ifndef FGML_MESHNORMALS_HPP_
+#define FGML_MESHNORMALS_HPP_
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector2.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Views.hpp"
+#include "FastMath.hpp"
+
+namespace FGML {
+	///
+	///	Mesh normals and tangents
+	///
+	///	Triangle lists only: indices holds three vertex indices per triangle.
+	///	Per-face work runs in SimdFloat blocks; per-vertex work gathers over
+	///	a vertex-to-corner CSR table, so each vertex is written by exactly
+	///	one worker and no atomics or per-thread copies are needed. Build the
+	///	table once per topology; deformation only re-runs the Compute* calls.
+	///
+	///	Vertices per worker chunk.
+	const size_t MESH_MIN_CHUNK = 4096;
+
+	///	Vertex v touches the corners corners[offsets[v] .. offsets[v + 1]);
+	///	corner c is vertex c % 3 of triangle c / 3. Corners of a vertex are
+	///	in triangle order, so the sums are deterministic.
+	struct MeshAdjacency {
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> corners;
+		size_t				  vertexCount	= 0;
+		size_t				  triangleCount = 0;
+	};
+
+	///	Per-triangle SoA results. x/y/z is the face normal or tangent; w is
+	///	the tangent handedness and unused for normals.
+	struct MeshFaceSoA {
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> w;
+
+		inline void Resize(size_t count);
+	};
+
+	inline void MeshFaceSoA::Resize(size_t count){
+		this->x.resize(count);
+		this->y.resize(count);
+		this->z.resize(count);
+		this->w.resize(count);
+	}
+	///
+	///	Mesh normals and tangents end
+	///
+
+	///
+	///	Mesh internals
+	///
+	///	Gathers the corners of a block of triangles into SoA lanes. Unused
+	///	lanes repeat the block's first triangle.
+	inline void LoadTriangleLanes(ConstVec3ArrayView positions, const uint32_t* indices, size_t lanes, SimdFloat (&p)[3][3]){
+		alignas(32) uint32_t offsets[3][SimdFloat::Width];
+		const size_t stride = positions.Stride();
+		for (size_t l = 0; l < SimdFloat::Width; ++l)
+			for (size_t k = 0; k < 3; ++k) offsets[k][l] = static_cast<uint32_t>(indices[((l < lanes) ? l : 0) * 3 + k] * stride);
+		const float* base = &positions.X(0);
+		for (size_t k = 0; k < 3; ++k){
+			p[k][0] = SimdFloat::Gather(base, offsets[k]);
+			p[k][1] = SimdFloat::Gather(base + 1, offsets[k]);
+			p[k][2] = SimdFloat::Gather(base + 2, offsets[k]);
+		}
+	}
+
+	inline void LoadTriangleUVLanes(const Vector2* uvs, const uint32_t* indices, size_t lanes, SimdFloat (&uv)[3][2]){
+		alignas(32) float e[3][2][SimdFloat::Width] = {};
+		for (size_t l = 0; l < lanes; ++l){
+			for (size_t k = 0; k < 3; ++k){
+				const Vector2& t = uvs[indices[l * 3 + k]];
+				e[k][0][l] = getXComponent(t);
+				e[k][1][l] = getYComponent(t);
+			}
+		}
+		for (size_t k = 0; k < 3; ++k){
+			uv[k][0] = SimdFloat::LoadAligned(e[k][0]);
+			uv[k][1] = SimdFloat::LoadAligned(e[k][1]);
+		}
+	}
+
+	///	Scales (x, y, z) to unit length in place; zero vectors stay zero.
+	inline float MeshNormalize(float& x, float& y, float& z){
+		const float length = std::sqrt(x * x + y * y + z * z);
+		const float inv = (length > 0.0f) ? 1.0f / length : 0.0f;
+		x *= inv;
+		y *= inv;
+		z *= inv;
+		return length;
+	}
+
+	///	(x, y, z) minus its component along the unit vector n.
+	inline void MeshReject(float& x, float& y, float& z, float nx, float ny, float nz){
+		const float d = x * nx + y * ny + z * nz;
+		x -= d * nx;
+		y -= d * ny;
+		z -= d * nz;
+	}
+	///
+	///	Mesh internals end
+	///
+
+	///
+	///	Mesh entry points
+	///
+	///	Counting sort of the 3 * triangleCount corners by vertex. Serial: it
+	///	is linear, runs once per topology and a parallel histogram would need
+	///	a vertexCount-sized array per worker.
+	inline void BuildMeshAdjacency(const uint32_t* indices, size_t triangleCount, size_t vertexCount, MeshAdjacency& out){
+		assert(3 * triangleCount <= UINT32_MAX && "Too many triangles for 32-bit corners");
+		out.vertexCount	  = vertexCount;
+		out.triangleCount = triangleCount;
+		out.offsets.assign(vertexCount + 1, 0);
+		out.corners.resize(3 * triangleCount);
+
+		for (size_t c = 0; c < 3 * triangleCount; ++c){
+			assert(indices[c] < vertexCount && "Vertex index out of range");
+			++out.offsets[indices[c] + 1];
+		}
+		for (size_t v = 0; v < vertexCount; ++v) out.offsets[v + 1] += out.offsets[v];
+
+		std::vector<uint32_t> cursor(out.offsets.begin(), out.offsets.end() - 1);
+		for (size_t c = 0; c < 3 * triangleCount; ++c) out.corners[cursor[indices[c]]++] = static_cast<uint32_t>(c);
+	}
+
+	///	Face normals (v1 - v0) x (v2 - v0). Unnormalized, the length is twice
+	///	the triangle area, which is the weight vertex normals want.
+	inline void ComputeFaceNormals(ConstVec3ArrayView positions, const uint32_t* indices, size_t triangleCount,
+								   MeshFaceSoA& faces, bool normalize = false, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MeshFaceNormals);
+		faces.Resize(triangleCount);
+		ForEachSimdBlock(triangleCount, threadCount, [&](size_t f, size_t lanes){
+			SimdFloat p[3][3];
+			LoadTriangleLanes(positions, indices + f * 3, lanes, p);
+			const SimdFloat e1x = p[1][0] - p[0][0], e1y = p[1][1] - p[0][1], e1z = p[1][2] - p[0][2];
+			const SimdFloat e2x = p[2][0] - p[0][0], e2y = p[2][1] - p[0][1], e2z = p[2][2] - p[0][2];
+			SimdFloat nx = e1y * e2z - e1z * e2y;
+			SimdFloat ny = e1z * e2x - e1x * e2z;
+			SimdFloat nz = e1x * e2y - e1y * e2x;
+			if (normalize){
+				const SimdFloat length = Sqrt(MulAdd(nx, nx, MulAdd(ny, ny, nz * nz)));
+				const SimdFloat inv = Select(CmpGt(length, SimdFloat(0.0f)), SimdFloat(1.0f) / length, SimdFloat(0.0f));
+				nx *= inv;
+				ny *= inv;
+				nz *= inv;
+			}
+			StoreLanes(nx, faces.x.data() + f, lanes);
+			StoreLanes(ny, faces.y.data() + f, lanes);
+			StoreLanes(nz, faces.z.data() + f, lanes);
+		});
+	}
+
+	///	Area-weighted unit vertex normals. faces is scratch for the face
+	///	normals, kept by the caller so per-frame calls do not allocate.
+	///	Vertices without a non-degenerate face get a zero normal.
+	inline void ComputeVertexNormals(ConstVec3ArrayView positions, const uint32_t* indices, const MeshAdjacency& adjacency,
+									 MeshFaceSoA& faces, Vec3ArrayView normals, size_t threadCount = 0){
+		assert(normals.size() >= adjacency.vertexCount && "Mismatched batch sizes!");
+		ComputeFaceNormals(positions, indices, adjacency.triangleCount, faces, false, threadCount);
+
+		FGML_SCOPED_TIMER(MeshVertexNormals);
+		ParallelFor(adjacency.vertexCount, MESH_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t v = begin; v < end; ++v){
+				float x = 0.0f, y = 0.0f, z = 0.0f;
+				for (uint32_t k = adjacency.offsets[v]; k < adjacency.offsets[v + 1]; ++k){
+					const uint32_t f = adjacency.corners[k] / 3;
+					x += faces.x[f];
+					y += faces.y[f];
+					z += faces.z[f];
+				}
+				MeshNormalize(x, y, z);
+				normals.X(v) = x;
+				normals.Y(v) = y;
+				normals.Z(v) = z;
+			}
+		}, threadCount);
+	}
+
+	///	Per-face unit tangents along dP/du, as MikkTSpace builds them; w is
+	///	+1 for faces that wind counter-clockwise in UV space and -1 for
+	///	mirrored ones. Faces with degenerate UVs get a zero tangent.
+	inline void ComputeFaceTangents(ConstVec3ArrayView positions, const Vector2* uvs, const uint32_t* indices,
+									size_t triangleCount, MeshFaceSoA& faces, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MeshFaceTangents);
+		faces.Resize(triangleCount);
+		ForEachSimdBlock(triangleCount, threadCount, [&](size_t f, size_t lanes){
+			SimdFloat p[3][3], uv[3][2];
+			LoadTriangleLanes(positions, indices + f * 3, lanes, p);
+			LoadTriangleUVLanes(uvs, indices + f * 3, lanes, uv);
+			const SimdFloat du1 = uv[1][0] - uv[0][0], dv1 = uv[1][1] - uv[0][1];
+			const SimdFloat du2 = uv[2][0] - uv[0][0], dv2 = uv[2][1] - uv[0][1];
+			const SimdFloat signedArea = du1 * dv2 - dv1 * du2;
+
+			// dP/du up to the 1 / signedArea factor, whose sign is applied below.
+			const SimdFloat tx = dv2 * (p[1][0] - p[0][0]) - dv1 * (p[2][0] - p[0][0]);
+			const SimdFloat ty = dv2 * (p[1][1] - p[0][1]) - dv1 * (p[2][1] - p[0][1]);
+			const SimdFloat tz = dv2 * (p[1][2] - p[0][2]) - dv1 * (p[2][2] - p[0][2]);
+			const SimdFloat length = Sqrt(MulAdd(tx, tx, MulAdd(ty, ty, tz * tz)));
+
+			const SimdFloat flip = CmpLt(signedArea, SimdFloat(0.0f));
+			const SimdFloat sign = Select(flip, SimdFloat(-1.0f), SimdFloat(1.0f));
+			const SimdFloat valid = And(CmpGt(Abs(signedArea), SimdFloat(0.0f)), CmpGt(length, SimdFloat(0.0f)));
+			const SimdFloat scale = Select(valid, sign / length, SimdFloat(0.0f));
+
+			StoreLanes(tx * scale, faces.x.data() + f, lanes);
+			StoreLanes(ty * scale, faces.y.data() + f, lanes);
+			StoreLanes(tz * scale, faces.z.data() + f, lanes);
+			StoreLanes(sign, faces.w.data() + f, lanes);
+		});
+	}
+
+	///	MikkTSpace-convention vertex tangents: bitangent = w * cross(n, t).
+	///	Each face tangent is projected into the vertex normal's plane and
+	///	weighted by the corner angle measured in that plane, as MikkTSpace
+	///	does. Unlike MikkTSpace nothing is split: vertices shared across a
+	///	UV mirror seam take the majority handedness, so meshes are expected
+	///	to be split on UV seams already (any exporter does). normals are the
+	///	unit vertex normals, e.g. from ComputeVertexNormals; faces is scratch.
+	inline void ComputeVertexTangents(ConstVec3ArrayView positions, ConstVec3ArrayView normals, const Vector2* uvs,
+									  const uint32_t* indices, const MeshAdjacency& adjacency, MeshFaceSoA& faces,
+									  Vector4* tangents, size_t threadCount = 0){
+		assert(normals.size() >= adjacency.vertexCount && "Mismatched batch sizes!");
+		ComputeFaceTangents(positions, uvs, indices, adjacency.triangleCount, faces, threadCount);
+
+		FGML_SCOPED_TIMER(MeshVertexTangents);
+		ParallelFor(adjacency.vertexCount, MESH_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t v = begin; v < end; ++v){
+				const float nx = normals.X(v), ny = normals.Y(v), nz = normals.Z(v);
+				float x = 0.0f, y = 0.0f, z = 0.0f, handedness = 0.0f;
+
+				for (uint32_t k = adjacency.offsets[v]; k < adjacency.offsets[v + 1]; ++k){
+					const uint32_t corner = adjacency.corners[k];
+					const uint32_t f = corner / 3;
+					const uint32_t* tri = indices + f * 3;
+					const uint32_t next = tri[(corner + 1) % 3], prev = tri[(corner + 2) % 3];
+
+					float tx = faces.x[f], ty = faces.y[f], tz = faces.z[f];
+					MeshReject(tx, ty, tz, nx, ny, nz);
+					if (MeshNormalize(tx, ty, tz) == 0.0f) continue;
+
+					float ax = positions.X(next) - positions.X(v), ay = positions.Y(next) - positions.Y(v), az = positions.Z(next) - positions.Z(v);
+					float bx = positions.X(prev) - positions.X(v), by = positions.Y(prev) - positions.Y(v), bz = positions.Z(prev) - positions.Z(v);
+					MeshReject(ax, ay, az, nx, ny, nz);
+					MeshReject(bx, by, bz, nx, ny, nz);
+					const float lengths = std::sqrt((ax * ax + ay * ay + az * az) * (bx * bx + by * by + bz * bz));
+					const float angle = FastAcos((lengths > 0.0f) ? (ax * bx + ay * by + az * bz) / lengths : 1.0f);
+
+					x += tx * angle;
+					y += ty * angle;
+					z += tz * angle;
+					handedness += faces.w[f];
+				}
+
+				MeshReject(x, y, z, nx, ny, nz);
+				if (MeshNormalize(x, y, z) == 0.0f){
+					// No usable UVs: any unit vector in the tangent plane.
+					const bool useX = std::fabs(nx) < 0.9f;
+					x = useX ? 1.0f : 0.0f;
+					y = useX ? 0.0f : 1.0f;
+					z = 0.0f;
+					MeshReject(x, y, z, nx, ny, nz);
+					MeshNormalize(x, y, z);
+				}
+				tangents[v] = Vector4(x, y, z, (handedness < 0.0f) ? -1.0f : 1.0f);
+			}
+		}, threadCount);
+	}
+	///
+	///	Mesh entry points end
+	///
+};
+
+#endif // FGML_MESHNORMALS_HPP_
\ No newline at end of file
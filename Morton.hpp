@@ -0,0 +1,595 @@
+#ifndef FGML_MORTON_HPP_
+#define FGML_MORTON_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Views.hpp"
+
+#if defined(__BMI2__)
+	#include <immintrin.h>
+#endif
+
+namespace FGML {
+	///
+	///	Morton codes
+	///
+	///	Z-curve codes interleave the quantized x, y and z cells with x in the
+	///	highest bit of each triple: 10 bits per axis in a uint32_t (30-bit
+	///	codes) or 21 bits per axis in a uint64_t (63-bit codes). Sorting by
+	///	code puts points that are close in space close in memory.
+	///
+	const uint32_t MORTON30_AXIS_BITS = 10;
+	const uint32_t MORTON63_AXIS_BITS = 21;
+
+	const size_t MORTON_MIN_CHUNK = 16384;
+	///	Radix digit width; 30-bit codes sort in 4 passes, 63-bit in 8.
+	const uint32_t MORTON_RADIX_BITS = 8;
+	const size_t   MORTON_RADIX_SIZE = size_t(1) << MORTON_RADIX_BITS;
+
+	///	Magic-bit spreading: inserts two zero bits after every input bit.
+	inline uint32_t MortonSpread10(uint32_t v){
+		v &= 0x000003ffu;
+		v = (v | (v << 16)) & 0xff0000ffu;
+		v = (v | (v <<  8)) & 0x0300f00fu;
+		v = (v | (v <<  4)) & 0x030c30c3u;
+		v = (v | (v <<  2)) & 0x09249249u;
+		return v;
+	}
+
+	inline uint32_t MortonCompact10(uint32_t v){
+		v &= 0x09249249u;
+		v = (v ^ (v >>  2)) & 0x030c30c3u;
+		v = (v ^ (v >>  4)) & 0x0300f00fu;
+		v = (v ^ (v >>  8)) & 0xff0000ffu;
+		v = (v ^ (v >> 16)) & 0x000003ffu;
+		return v;
+	}
+
+	inline uint64_t MortonSpread21(uint64_t v){
+		v &= 0x00000000001fffffull;
+		v = (v | (v << 32)) & 0x001f00000000ffffull;
+		v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+		v = (v | (v <<  8)) & 0x100f00f00f00f00full;
+		v = (v | (v <<  4)) & 0x10c30c30c30c30c3ull;
+		v = (v | (v <<  2)) & 0x1249249249249249ull;
+		return v;
+	}
+
+	inline uint64_t MortonCompact21(uint64_t v){
+		v &= 0x1249249249249249ull;
+		v = (v ^ (v >>  2)) & 0x10c30c30c30c30c3ull;
+		v = (v ^ (v >>  4)) & 0x100f00f00f00f00full;
+		v = (v ^ (v >>  8)) & 0x001f0000ff0000ffull;
+		v = (v ^ (v >> 16)) & 0x001f00000000ffffull;
+		v = (v ^ (v >> 32)) & 0x00000000001fffffull;
+		return v;
+	}
+
+	///	BMI2 pdep/pext do each axis in one instruction. Define
+	///	FGML_MORTON_NO_PDEP on targets where they are microcoded (AMD before
+	///	Zen 3) to fall back to the magic-bit sequences.
+	inline uint32_t MortonEncode30(uint32_t x, uint32_t y, uint32_t z){
+	#if defined(__BMI2__) && !defined(FGML_MORTON_NO_PDEP)
+		return _pdep_u32(x, 0x24924924u) | _pdep_u32(y, 0x12492492u) | _pdep_u32(z, 0x09249249u);
+	#else
+		return (MortonSpread10(x) << 2) | (MortonSpread10(y) << 1) | MortonSpread10(z);
+	#endif
+	}
+
+	inline void MortonDecode30(uint32_t code, uint32_t& x, uint32_t& y, uint32_t& z){
+	#if defined(__BMI2__) && !defined(FGML_MORTON_NO_PDEP)
+		x = _pext_u32(code, 0x24924924u);
+		y = _pext_u32(code, 0x12492492u);
+		z = _pext_u32(code, 0x09249249u);
+	#else
+		x = MortonCompact10(code >> 2);
+		y = MortonCompact10(code >> 1);
+		z = MortonCompact10(code);
+	#endif
+	}
+
+	inline uint64_t MortonEncode63(uint32_t x, uint32_t y, uint32_t z){
+	#if defined(__BMI2__) && defined(__x86_64__) && !defined(FGML_MORTON_NO_PDEP)
+		return _pdep_u64(x, 0x4924924924924924ull) | _pdep_u64(y, 0x2492492492492492ull)
+			 | _pdep_u64(z, 0x1249249249249249ull);
+	#else
+		return (MortonSpread21(x) << 2) | (MortonSpread21(y) << 1) | MortonSpread21(z);
+	#endif
+	}
+
+	inline void MortonDecode63(uint64_t code, uint32_t& x, uint32_t& y, uint32_t& z){
+	#if defined(__BMI2__) && defined(__x86_64__) && !defined(FGML_MORTON_NO_PDEP)
+		x = static_cast<uint32_t>(_pext_u64(code, 0x4924924924924924ull));
+		y = static_cast<uint32_t>(_pext_u64(code, 0x2492492492492492ull));
+		z = static_cast<uint32_t>(_pext_u64(code, 0x1249249249249249ull));
+	#else
+		x = static_cast<uint32_t>(MortonCompact21(code >> 2));
+		y = static_cast<uint32_t>(MortonCompact21(code >> 1));
+		z = static_cast<uint32_t>(MortonCompact21(code));
+	#endif
+	}
+	///
+	///	Morton codes end
+	///
+
+	///
+	///	Quantization
+	///
+	///	Axis-aligned box the codes are quantized over.
+	struct MortonBounds {
+		Vector3 minimum = Vector3(0.0f, 0.0f, 0.0f);
+		Vector3 maximum = Vector3(1.0f, 1.0f, 1.0f);
+	};
+
+	///	Cell mapping for one code width: cell = (p - origin) * scale, clamped
+	///	to [0, maxCell]; decoding returns cell centres. A flat axis maps
+	///	everything to cell 0.
+	struct MortonGrid {
+		float origin[3];
+		float scale[3];
+		float cellSize[3];
+		float maxCell;
+	};
+
+	inline MortonGrid MakeMortonGrid(const MortonBounds& bounds, uint32_t axisBits){
+		const float lo[3] = { getXComponent(bounds.minimum), getYComponent(bounds.minimum), getZComponent(bounds.minimum) };
+		const float hi[3] = { getXComponent(bounds.maximum), getYComponent(bounds.maximum), getZComponent(bounds.maximum) };
+		const float cells = static_cast<float>(uint32_t(1) << axisBits);
+
+		MortonGrid grid;
+		for (size_t a = 0; a < 3; ++a){
+			const float extent = hi[a] - lo[a];
+			grid.origin[a]	 = lo[a];
+			grid.scale[a]	 = (extent > 0.0f) ? cells / extent : 0.0f;
+			grid.cellSize[a] = (extent > 0.0f) ? extent / cells : 0.0f;
+		}
+		grid.maxCell = cells - 1.0f;
+		return grid;
+	}
+
+	///	NaN coordinates land in cell 0.
+	inline uint32_t MortonCell(const MortonGrid& grid, size_t axis, float value){
+		const float cell = (value - grid.origin[axis]) * grid.scale[axis];
+		return static_cast<uint32_t>(MIN(MAX(cell, 0.0f), grid.maxCell));
+	}
+
+	inline float MortonCellCentre(const MortonGrid& grid, size_t axis, uint32_t cell){
+		return grid.origin[axis] + (static_cast<float>(cell) + 0.5f) * grid.cellSize[axis];
+	}
+
+	inline uint32_t MortonCode30(const Vector3& point, const MortonBounds& bounds){
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON30_AXIS_BITS);
+		return MortonEncode30( MortonCell(grid, 0, getXComponent(point)),
+							   MortonCell(grid, 1, getYComponent(point)),
+							   MortonCell(grid, 2, getZComponent(point)) );
+	}
+
+	inline uint64_t MortonCode63(const Vector3& point, const MortonBounds& bounds){
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON63_AXIS_BITS);
+		return MortonEncode63( MortonCell(grid, 0, getXComponent(point)),
+							   MortonCell(grid, 1, getYComponent(point)),
+							   MortonCell(grid, 2, getZComponent(point)) );
+	}
+
+	///	Centre of the cell a code names.
+	inline Vector3 MortonPoint30(uint32_t code, const MortonBounds& bounds){
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON30_AXIS_BITS);
+		uint32_t x, y, z;
+		MortonDecode30(code, x, y, z);
+		return Vector3(MortonCellCentre(grid, 0, x), MortonCellCentre(grid, 1, y), MortonCellCentre(grid, 2, z));
+	}
+
+	inline Vector3 MortonPoint63(uint64_t code, const MortonBounds& bounds){
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON63_AXIS_BITS);
+		uint32_t x, y, z;
+		MortonDecode63(code, x, y, z);
+		return Vector3(MortonCellCentre(grid, 0, x), MortonCellCentre(grid, 1, y), MortonCellCentre(grid, 2, z));
+	}
+
+	///	Tight bounds of a point set, reduced per worker chunk.
+	inline MortonBounds ComputeMortonBounds(ConstVec3ArrayView points, size_t threadCount = 0){
+		MortonBounds bounds;
+		if (points.size() == 0) return bounds;
+
+		const size_t chunks = ChunkCount(points.size(), MORTON_MIN_CHUNK, threadCount);
+		std::vector<float> lo(chunks * 3, std::numeric_limits<float>::max());
+		std::vector<float> hi(chunks * 3, -std::numeric_limits<float>::max());
+
+		ParallelFor(points.size(), MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t c){
+			float* l = &lo[c * 3];
+			float* h = &hi[c * 3];
+			for (size_t i = begin; i < end; ++i){
+				l[0] = MIN(l[0], points.X(i)); h[0] = MAX(h[0], points.X(i));
+				l[1] = MIN(l[1], points.Y(i)); h[1] = MAX(h[1], points.Y(i));
+				l[2] = MIN(l[2], points.Z(i)); h[2] = MAX(h[2], points.Z(i));
+			}
+		}, threadCount);
+
+		for (size_t c = 1; c < chunks; ++c){
+			for (size_t a = 0; a < 3; ++a){
+				lo[a] = MIN(lo[a], lo[c * 3 + a]);
+				hi[a] = MAX(hi[a], hi[c * 3 + a]);
+			}
+		}
+		bounds.minimum = Vector3(lo[0], lo[1], lo[2]);
+		bounds.maximum = Vector3(hi[0], hi[1], hi[2]);
+		return bounds;
+	}
+	///
+	///	Quantization end
+	///
+
+	///
+	///	Definition of MortonLanes
+	///
+	///	Integer lanes for the 30-bit batch paths. AVX2 runs 8 lanes; SSE2
+	///	(and AVX without AVX2, which lacks 256-bit integer shifts) runs 4;
+	///	otherwise one scalar lane.
+	///
+	struct MortonLanes {
+	#if defined(__AVX2__)
+		using Int	= __m256i;
+		using Float = __m256;
+		static const size_t Width = 8;
+
+		static inline Float Set(float value)						{ return _mm256_set1_ps(value); }
+		static inline Float LoadFloat(const float* src)				{ return _mm256_load_ps(src); }
+		static inline void	StoreFloat(float* dst, Float value)		{ _mm256_store_ps(dst, value); }
+		static inline Int	Load(const uint32_t* src)				{ return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)); }
+		static inline void	Store(uint32_t* dst, Int value)			{ _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), value); }
+		static inline Int	Mask(uint32_t mask)						{ return _mm256_set1_epi32(static_cast<int>(mask)); }
+		static inline Int	And(Int a, Int b)						{ return _mm256_and_si256(a, b); }
+		static inline Int	Or(Int a, Int b)						{ return _mm256_or_si256(a, b); }
+		static inline Int	Xor(Int a, Int b)						{ return _mm256_xor_si256(a, b); }
+		template<int Bits> static inline Int ShiftLeft(Int a)	{ return _mm256_slli_epi32(a, Bits); }
+		template<int Bits> static inline Int ShiftRight(Int a)	{ return _mm256_srli_epi32(a, Bits); }
+		static inline Int	Cell(Float value, Float origin, Float scale, Float maxCell){
+			const Float cell = _mm256_mul_ps(_mm256_sub_ps(value, origin), scale);
+			return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(cell, _mm256_setzero_ps()), maxCell));
+		}
+		static inline Float Centre(Int cell, Float origin, Float cellSize){
+			const Float centre = _mm256_add_ps(_mm256_cvtepi32_ps(cell), _mm256_set1_ps(0.5f));
+			return _mm256_add_ps(origin, _mm256_mul_ps(centre, cellSize));
+		}
+	#elif defined(FGML_SIMD_AVX) || defined(FGML_SIMD_SSE)
+		using Int	= __m128i;
+		using Float = __m128;
+		static const size_t Width = 4;
+
+		static inline Float Set(float value)						{ return _mm_set1_ps(value); }
+		static inline Float LoadFloat(const float* src)				{ return _mm_load_ps(src); }
+		static inline void	StoreFloat(float* dst, Float value)		{ _mm_store_ps(dst, value); }
+		static inline Int	Load(const uint32_t* src)				{ return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)); }
+		static inline void	Store(uint32_t* dst, Int value)			{ _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value); }
+		static inline Int	Mask(uint32_t mask)						{ return _mm_set1_epi32(static_cast<int>(mask)); }
+		static inline Int	And(Int a, Int b)						{ return _mm_and_si128(a, b); }
+		static inline Int	Or(Int a, Int b)						{ return _mm_or_si128(a, b); }
+		static inline Int	Xor(Int a, Int b)						{ return _mm_xor_si128(a, b); }
+		template<int Bits> static inline Int ShiftLeft(Int a)	{ return _mm_slli_epi32(a, Bits); }
+		template<int Bits> static inline Int ShiftRight(Int a)	{ return _mm_srli_epi32(a, Bits); }
+		static inline Int	Cell(Float value, Float origin, Float scale, Float maxCell){
+			const Float cell = _mm_mul_ps(_mm_sub_ps(value, origin), scale);
+			return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(cell, _mm_setzero_ps()), maxCell));
+		}
+		static inline Float Centre(Int cell, Float origin, Float cellSize){
+			const Float centre = _mm_add_ps(_mm_cvtepi32_ps(cell), _mm_set1_ps(0.5f));
+			return _mm_add_ps(origin, _mm_mul_ps(centre, cellSize));
+		}
+	#else
+		using Int	= uint32_t;
+		using Float = float;
+		static const size_t Width = 1;
+
+		static inline Float Set(float value)						{ return value; }
+		static inline Float LoadFloat(const float* src)				{ return *src; }
+		static inline void	StoreFloat(float* dst, Float value)		{ *dst = value; }
+		static inline Int	Load(const uint32_t* src)				{ return *src; }
+		static inline void	Store(uint32_t* dst, Int value)			{ *dst = value; }
+		static inline Int	Mask(uint32_t mask)						{ return mask; }
+		static inline Int	And(Int a, Int b)						{ return a & b; }
+		static inline Int	Or(Int a, Int b)						{ return a | b; }
+		static inline Int	Xor(Int a, Int b)						{ return a ^ b; }
+		template<int Bits> static inline Int ShiftLeft(Int a)	{ return a << Bits; }
+		template<int Bits> static inline Int ShiftRight(Int a)	{ return a >> Bits; }
+		static inline Int	Cell(Float value, Float origin, Float scale, Float maxCell){
+			const Float cell = (value - origin) * scale;
+			return static_cast<uint32_t>(MIN(MAX(cell, 0.0f), maxCell));
+		}
+		static inline Float Centre(Int cell, Float origin, Float cellSize){
+			return origin + (static_cast<float>(cell) + 0.5f) * cellSize;
+		}
+	#endif
+
+		///	Lane-wise MortonSpread10 / MortonCompact10.
+		static inline Int Spread10(Int v){
+			v = And(v, Mask(0x000003ffu));
+			v = And(Or(v, ShiftLeft<16>(v)), Mask(0xff0000ffu));
+			v = And(Or(v, ShiftLeft<8>(v)), Mask(0x0300f00fu));
+			v = And(Or(v, ShiftLeft<4>(v)), Mask(0x030c30c3u));
+			v = And(Or(v, ShiftLeft<2>(v)), Mask(0x09249249u));
+			return v;
+		}
+
+		static inline Int Compact10(Int v){
+			v = And(v, Mask(0x09249249u));
+			v = And(Xor(v, ShiftRight<2>(v)), Mask(0x030c30c3u));
+			v = And(Xor(v, ShiftRight<4>(v)), Mask(0x0300f00fu));
+			v = And(Xor(v, ShiftRight<8>(v)), Mask(0xff0000ffu));
+			v = And(Xor(v, ShiftRight<16>(v)), Mask(0x000003ffu));
+			return v;
+		}
+	};
+
+	///	Runs block(first, lanes) over MortonLanes::Width blocks of [0, count)
+	///	in parallel; the last block of each chunk may be partial.
+	template<typename Block>
+	inline void ForEachMortonBlock(size_t count, size_t threadCount, Block&& block){
+		ParallelFor(count, MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; i += MortonLanes::Width) block(i, MIN(MortonLanes::Width, end - i));
+		}, threadCount);
+	}
+
+	///	Quantizes one block of points to per-axis cells (unused lanes are 0).
+	inline void MortonCellLanes(ConstVec3ArrayView points, size_t lanes, const MortonGrid& grid,
+								MortonLanes::Int& cx, MortonLanes::Int& cy, MortonLanes::Int& cz){
+		alignas(32) float x[MortonLanes::Width] = {}, y[MortonLanes::Width] = {}, z[MortonLanes::Width] = {};
+		for (size_t l = 0; l < lanes; ++l){
+			x[l] = points.X(l);
+			y[l] = points.Y(l);
+			z[l] = points.Z(l);
+		}
+		const MortonLanes::Float maxCell = MortonLanes::Set(grid.maxCell);
+		cx = MortonLanes::Cell(MortonLanes::LoadFloat(x), MortonLanes::Set(grid.origin[0]), MortonLanes::Set(grid.scale[0]), maxCell);
+		cy = MortonLanes::Cell(MortonLanes::LoadFloat(y), MortonLanes::Set(grid.origin[1]), MortonLanes::Set(grid.scale[1]), maxCell);
+		cz = MortonLanes::Cell(MortonLanes::LoadFloat(z), MortonLanes::Set(grid.origin[2]), MortonLanes::Set(grid.scale[2]), maxCell);
+	}
+	///
+	///	Definition of MortonLanes end
+	///
+
+	///
+	///	Batch encode and decode
+	///
+	inline void MortonEncode30Batch(ConstVec3ArrayView points, const MortonBounds& bounds,
+									uint32_t* codes, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MortonEncodeBatch);
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON30_AXIS_BITS);
+
+		ForEachMortonBlock(points.size(), threadCount, [&](size_t i, size_t lanes){
+			MortonLanes::Int cx, cy, cz;
+			MortonCellLanes(points.Subview(i, lanes), lanes, grid, cx, cy, cz);
+			const MortonLanes::Int code = MortonLanes::Or(MortonLanes::ShiftLeft<2>(MortonLanes::Spread10(cx)),
+										  MortonLanes::Or(MortonLanes::ShiftLeft<1>(MortonLanes::Spread10(cy)),
+														  MortonLanes::Spread10(cz)));
+			if (lanes == MortonLanes::Width){
+				MortonLanes::Store(codes + i, code);
+				return;
+			}
+			uint32_t padded[MortonLanes::Width];
+			MortonLanes::Store(padded, code);
+			for (size_t l = 0; l < lanes; ++l) codes[i + l] = padded[l];
+		});
+	}
+
+	///	Quantization is vectorized; the 21-bit interleave runs per lane
+	///	(pdep with BMI2) since 64-bit lane shifts would halve the width.
+	inline void MortonEncode63Batch(ConstVec3ArrayView points, const MortonBounds& bounds,
+									uint64_t* codes, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MortonEncodeBatch);
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON63_AXIS_BITS);
+
+		ForEachMortonBlock(points.size(), threadCount, [&](size_t i, size_t lanes){
+			MortonLanes::Int cx, cy, cz;
+			MortonCellLanes(points.Subview(i, lanes), lanes, grid, cx, cy, cz);
+			uint32_t x[MortonLanes::Width], y[MortonLanes::Width], z[MortonLanes::Width];
+			MortonLanes::Store(x, cx);
+			MortonLanes::Store(y, cy);
+			MortonLanes::Store(z, cz);
+			for (size_t l = 0; l < lanes; ++l) codes[i + l] = MortonEncode63(x[l], y[l], z[l]);
+		});
+	}
+
+	///	Writes the cell centre of every code into out (count is out.size()).
+	inline void MortonDecode30Batch(const uint32_t* codes, const MortonBounds& bounds,
+									Vec3ArrayView out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MortonDecodeBatch);
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON30_AXIS_BITS);
+
+		ForEachMortonBlock(out.size(), threadCount, [&](size_t i, size_t lanes){
+			uint32_t block[MortonLanes::Width] = {};
+			for (size_t l = 0; l < lanes; ++l) block[l] = codes[i + l];
+			const MortonLanes::Int code = MortonLanes::Load(block);
+
+			alignas(32) float p[3][MortonLanes::Width];
+			const MortonLanes::Int cell[3] = { MortonLanes::Compact10(MortonLanes::ShiftRight<2>(code)),
+											   MortonLanes::Compact10(MortonLanes::ShiftRight<1>(code)),
+											   MortonLanes::Compact10(code) };
+			for (size_t a = 0; a < 3; ++a)
+				MortonLanes::StoreFloat(p[a], MortonLanes::Centre(cell[a], MortonLanes::Set(grid.origin[a]),
+																	MortonLanes::Set(grid.cellSize[a])));
+			for (size_t l = 0; l < lanes; ++l){
+				out.X(i + l) = p[0][l];
+				out.Y(i + l) = p[1][l];
+				out.Z(i + l) = p[2][l];
+			}
+		});
+	}
+
+	inline void MortonDecode63Batch(const uint64_t* codes, const MortonBounds& bounds,
+									Vec3ArrayView out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MortonDecodeBatch);
+		const MortonGrid grid = MakeMortonGrid(bounds, MORTON63_AXIS_BITS);
+
+		ParallelFor(out.size(), MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i){
+				uint32_t x, y, z;
+				MortonDecode63(codes[i], x, y, z);
+				out.X(i) = MortonCellCentre(grid, 0, x);
+				out.Y(i) = MortonCellCentre(grid, 1, y);
+				out.Z(i) = MortonCellCentre(grid, 2, z);
+			}
+		}, threadCount);
+	}
+	///
+	///	Batch encode and decode end
+	///
+
+	///
+	///	Radix sort
+	///
+	///	Stable LSD radix sort of keys with a uint32_t value per key, over the
+	///	low keyBits bits. Each pass histograms worker chunks in parallel,
+	///	scans the (digit, chunk) table and scatters each chunk to its own
+	///	offsets, so the order within a digit is preserved. Passes whose digit
+	///	is the same for every key are skipped.
+	template<typename Key>
+	inline void RadixSortPairs(Key* keys, uint32_t* values, size_t count, uint32_t keyBits, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MortonSort);
+		assert(keyBits <= sizeof(Key) * 8 && "More key bits than the key holds");
+		if (count < 2) return;
+
+		const size_t chunks = ChunkCount(count, MORTON_MIN_CHUNK, threadCount);
+		std::vector<Key>	  keyScratch(count);
+		std::vector<uint32_t> valueScratch(count);
+		std::vector<size_t>	  offsets(chunks * MORTON_RADIX_SIZE);
+
+		Key*	  srcKeys	= keys;
+		uint32_t* srcValues = values;
+		Key*	  dstKeys	= keyScratch.data();
+		uint32_t* dstValues = valueScratch.data();
+
+		for (uint32_t shift = 0; shift < keyBits; shift += MORTON_RADIX_BITS){
+			const Key digitMask = static_cast<Key>(MORTON_RADIX_SIZE - 1);
+
+			ParallelFor(count, MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t c){
+				size_t* histogram = &offsets[c * MORTON_RADIX_SIZE];
+				for (size_t d = 0; d < MORTON_RADIX_SIZE; ++d) histogram[d] = 0;
+				for (size_t i = begin; i < end; ++i) ++histogram[(srcKeys[i] >> shift) & digitMask];
+			}, threadCount);
+
+			// Digit-major, chunk-minor exclusive scan.
+			size_t running = 0;
+			bool   trivial = false;
+			for (size_t d = 0; d < MORTON_RADIX_SIZE; ++d){
+				size_t digitTotal = 0;
+				for (size_t c = 0; c < chunks; ++c){
+					const size_t n = offsets[c * MORTON_RADIX_SIZE + d];
+					offsets[c * MORTON_RADIX_SIZE + d] = running;
+					running	   += n;
+					digitTotal += n;
+				}
+				if (digitTotal == count) trivial = true;
+			}
+			if (trivial) continue;
+
+			ParallelFor(count, MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t c){
+				size_t* offset = &offsets[c * MORTON_RADIX_SIZE];
+				for (size_t i = begin; i < end; ++i){
+					const size_t slot = offset[(srcKeys[i] >> shift) & digitMask]++;
+					dstKeys[slot]	= srcKeys[i];
+					dstValues[slot] = srcValues[i];
+				}
+			}, threadCount);
+
+			std::swap(srcKeys, dstKeys);
+			std::swap(srcValues, dstValues);
+		}
+
+		if (srcKeys != keys){
+			ParallelFor(count, MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+				for (size_t i = begin; i < end; ++i){
+					keys[i]	  = srcKeys[i];
+					values[i] = srcValues[i];
+				}
+			}, threadCount);
+		}
+	}
+
+	///	Sorts codes ascending in place; order[i] receives the original index
+	///	of the i-th code. Equal codes keep their input order.
+	inline void MortonSort(uint32_t* codes, size_t count, uint32_t* order, size_t threadCount = 0){
+		assert(count <= std::numeric_limits<uint32_t>::max() && "Too many points for 32-bit indices");
+		for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+		RadixSortPairs(codes, order, count, 3 * MORTON30_AXIS_BITS, threadCount);
+	}
+
+	inline void MortonSort(uint64_t* codes, size_t count, uint32_t* order, size_t threadCount = 0){
+		assert(count <= std::numeric_limits<uint32_t>::max() && "Too many points for 32-bit indices");
+		for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+		RadixSortPairs(codes, order, count, 3 * MORTON63_AXIS_BITS, threadCount);
+	}
+
+	///	Z-order permutation of a point set over its own bounds. 30-bit codes
+	///	resolve 1024 cells per axis; pass precise for 63-bit codes when the
+	///	set is large or clustered enough to need more.
+	inline void MortonOrder(ConstVec3ArrayView points, std::vector<uint32_t>& order,
+							bool precise = false, size_t threadCount = 0){
+		const size_t count = points.size();
+		const MortonBounds bounds = ComputeMortonBounds(points, threadCount);
+		order.resize(count);
+
+		if (precise){
+			std::vector<uint64_t> codes(count);
+			MortonEncode63Batch(points, bounds, codes.data(), threadCount);
+			MortonSort(codes.data(), count, order.data(), threadCount);
+		}
+		else {
+			std::vector<uint32_t> codes(count);
+			MortonEncode30Batch(points, bounds, codes.data(), threadCount);
+			MortonSort(codes.data(), count, order.data(), threadCount);
+		}
+	}
+	///
+	///	Radix sort end
+	///
+
+	///
+	///	Reordering
+	///
+	///	out[i] = in[order[i]]. out must not alias in.
+	template<typename T>
+	inline void ApplyOrder(const uint32_t* order, size_t count, const T* in, T* out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MortonReorder);
+		ParallelFor(count, MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i) out[i] = in[order[i]];
+		}, threadCount);
+	}
+
+	///	Positions in any stride; count is out.size().
+	inline void ApplyOrder(const uint32_t* order, ConstVec3ArrayView in, Vec3ArrayView out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(MortonReorder);
+		ParallelFor(out.size(), MORTON_MIN_CHUNK, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i){
+				const uint32_t src = order[i];
+				out.X(i) = in.X(src);
+				out.Y(i) = in.Y(src);
+				out.Z(i) = in.Z(src);
+			}
+		}, threadCount);
+	}
+
+	///	Reorders an owned array (positions or any payload) through a scratch
+	///	copy. Call once per attached array with the same order.
+	template<typename T>
+	inline void ApplyOrder(const std::vector<uint32_t>& order, std::vector<T>& data, size_t threadCount = 0){
+		assert(order.size() == data.size() && "Order and payload differ in length");
+		std::vector<T> sorted(data.size());
+		ApplyOrder(order.data(), order.size(), data.data(), sorted.data(), threadCount);
+		data.swap(sorted);
+	}
+	///
+	///	Reordering end
+	///
+};
+
+#endif // FGML_MORTON_HPP_
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef FGML_PARALLEL_HPP_
+#define FGML_PARALLEL_HPP_
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+
+namespace FGML {
+	///
+	///	Fork-join helpers used by the batch kernels
+	///
+	inline size_t HardwareThreads(void){
+		const unsigned count = std::thread::hardware_concurrency();
+		return (count == 0) ? 1 : static_cast<size_t>(count);
+	}
+
+	///	Number of contiguous chunks ParallelFor will split [0, count) into.
+	inline size_t ChunkCount(size_t count, size_t minChunk, size_t threadCount = 0){
+		if (threadCount == 0) threadCount = HardwareThreads();
+		if (minChunk == 0) minChunk = 1;
+
+		const size_t byWork = (count + minChunk - 1) / minChunk;
+		return MAX(size_t(1), MIN(threadCount, byWork));
+	}
+
+	///	Calls func(chunkBegin, chunkEnd, chunkIndex) for ChunkCount() contiguous
+	///	chunks of [0, count). Chunk 0 runs on the calling thread.
+	template<typename Func>
+	inline void ParallelFor(size_t count, size_t minChunk, Func&& func, size_t threadCount = 0){
+		const size_t chunks = ChunkCount(count, minChunk, threadCount);
+		if (chunks == 1){
+			func(size_t(0), count, size_t(0));
+			return;
+		}
+
+		const size_t step = (count + chunks - 1) / chunks;
+		std::vector<std::thread> workers;
+		workers.reserve(chunks - 1);
+
+	#ifdef FGML_INSTRUMENT
+		// Workers count their calls under the forking thread's scope label.
+		const char* scope = Instrument::CurrentScope();
+	#endif
+		for (size_t c = 1; c < chunks; ++c){
+			const size_t begin = MIN(count, c * step);
+			const size_t end   = MIN(count, begin + step);
+	#ifdef FGML_INSTRUMENT
+			workers.emplace_back([&func, begin, end, c, scope]{ Instrument::Scope inherit(scope); func(begin, end, c); });
+	#else
+			workers.emplace_back([&func, begin, end, c]{ func(begin, end, c); });
+	#endif
+		}
+
+		func(size_t(0), MIN(count, step), size_t(0));
+
+		for (std::thread& worker : workers){
+			worker.join();
+		}
+	}
+	///
+	///	Fork-join helpers end
+	///
+};
+
+#endif // FGML_PARALLEL_HPP_
\ No newline at end of file
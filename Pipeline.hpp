@@ -0,0 +1,533 @@
+#ifndef FGML_PIPELINE_HPP_
+#define FGML_PIPELINE_HPP_
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix4x4.hpp"
+#include "Views.hpp"
+
+#if defined(__F16C__)
+	#include <immintrin.h>
+#endif
+
+namespace FGML {
+	///
+	///	Definition of PipelineTile
+	///
+	///	Fixed-size SoA block of homogeneous points that every stage of a
+	///	Pipeline works on in turn. index holds the source index of each live
+	///	point, so stages that drop points (culling) keep track of them. Lanes
+	///	from count up to the next SimdFloat::Width multiple are padding that
+	///	stages may compute on but never emit.
+	///
+	///	512 points: 10 KB per tile, so a tile stays in L1 across all stages.
+	const size_t PIPELINE_TILE_SIZE = 512;
+	///	Tiles per worker chunk.
+	const size_t PIPELINE_MIN_TILES = 8;
+
+	struct PipelineTile {
+		size_t				 first;
+		size_t				 count;
+		alignas(32) uint32_t index[PIPELINE_TILE_SIZE];
+		alignas(32) float	 x[PIPELINE_TILE_SIZE];
+		alignas(32) float	 y[PIPELINE_TILE_SIZE];
+		alignas(32) float	 z[PIPELINE_TILE_SIZE];
+		alignas(32) float	 w[PIPELINE_TILE_SIZE];
+	};
+
+	///	Summed over workers, so stage times are CPU seconds, not wall time.
+	///	Stage 0 is the source.
+	struct PipelineStats {
+		std::vector<double> stageSeconds;
+		size_t				tiles  = 0;
+		size_t				input  = 0;
+		size_t				output = 0;
+	};
+	///
+	///	Definition of PipelineTile end
+	///
+
+	///
+	///	Pipeline internals
+	///
+	inline size_t PaddedLanes(size_t count){
+		return (count + SimdFloat::Width - 1) / SimdFloat::Width * SimdFloat::Width;
+	}
+
+	///	Zeroes the padding lanes a source leaves behind (w = 1).
+	inline void PadTile(PipelineTile& tile){
+		for (size_t i = tile.count; i < PaddedLanes(tile.count); ++i){
+			tile.index[i] = 0;
+			tile.x[i] = tile.y[i] = tile.z[i] = 0.0f;
+			tile.w[i] = 1.0f;
+		}
+	}
+
+	///	Pulls [begin, begin + bytes) towards L1 ahead of the next tile.
+	inline void PrefetchRange(const void* begin, size_t bytes){
+	#if defined(FGML_SIMD_AVX) || defined(FGML_SIMD_SSE)
+		const char* p = static_cast<const char*>(begin);
+		for (size_t offset = 0; offset < bytes; offset += 64) _mm_prefetch(p + offset, _MM_HINT_T0);
+	#else
+		(void)begin;
+		(void)bytes;
+	#endif
+	}
+
+	///	IEEE binary16 with round-to-nearest-even; overflow saturates to
+	///	infinity and NaN stays NaN.
+	inline uint16_t FloatToHalf(float value){
+		uint32_t f = SimdBits(value);
+		const uint32_t sign = (f >> 16) & 0x8000u;
+		f &= 0x7fffffffu;
+
+		uint32_t h;
+		if (f >= 0x47800000u){
+			h = (f > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+		}
+		else if (f < 0x38800000u){
+			// Subnormal: adding 0.5 lets the FPU round the mantissa into place.
+			h = SimdBits(SimdFromBits(f) + 0.5f) - 0x3f000000u;
+		}
+		else {
+			const uint32_t odd = (f >> 13) & 1u;
+			h = (f + 0xc8000fffu + odd) >> 13;
+		}
+		return static_cast<uint16_t>(h | sign);
+	}
+
+	inline float HalfToFloat(uint16_t half){
+		const uint32_t sign		= static_cast<uint32_t>(half & 0x8000u) << 16;
+		const uint32_t exponent = (half >> 10) & 0x1fu;
+		const uint32_t mantissa = half & 0x3ffu;
+
+		if (exponent == 0){
+			const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+			return SimdFromBits(SimdBits(magnitude) | sign);
+		}
+		if (exponent == 31) return SimdFromBits(sign | 0x7f800000u | (mantissa << 13));
+		return SimdFromBits(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+	///
+	///	Pipeline internals end
+	///
+
+	///
+	///	Source stages
+	///
+	///	A source fills tile.x/y/z/w and tile.index for the tile's range
+	///	[first, first + count) and can prefetch a range it will load next.
+	///
+	///	Positions stored as 16-bit grid coordinates: p = offset + q * scale.
+	class QuantizedSource {
+	private:
+		const uint16_t* m_data;
+		size_t			m_stride;
+		float			m_offset[3];
+		float			m_scale[3];
+	public:
+		QuantizedSource(const uint16_t* data, const Vector3& offset, const Vector3& scale, size_t stride = 3);
+
+		inline void operator()(PipelineTile& tile) const;
+		inline void Prefetch(size_t first, size_t count) const;
+	};
+
+	class Vec3Source {
+	private:
+		ConstVec3ArrayView m_points;
+	public:
+		explicit Vec3Source(ConstVec3ArrayView points);
+
+		inline void operator()(PipelineTile& tile) const;
+		inline void Prefetch(size_t first, size_t count) const;
+	};
+
+	class Vector4Source {
+	private:
+		const Vector4* m_points;
+	public:
+		explicit Vector4Source(const Vector4* points);
+
+		inline void operator()(PipelineTile& tile) const;
+		inline void Prefetch(size_t first, size_t count) const;
+	};
+
+	inline QuantizedSource::QuantizedSource(const uint16_t* data, const Vector3& offset, const Vector3& scale, size_t stride)
+	: m_data(data), m_stride(stride),
+	  m_offset{ getXComponent(offset), getYComponent(offset), getZComponent(offset) },
+	  m_scale{ getXComponent(scale), getYComponent(scale), getZComponent(scale) } {
+		assert(stride >= 3 && "Quantized points need three components");
+	}
+
+	inline void QuantizedSource::operator()(PipelineTile& tile) const {
+		const uint16_t* src = this->m_data + tile.first * this->m_stride;
+		for (size_t i = 0; i < tile.count; ++i, src += this->m_stride){
+			tile.index[i] = static_cast<uint32_t>(tile.first + i);
+			tile.x[i] = this->m_offset[0] + static_cast<float>(src[0]) * this->m_scale[0];
+			tile.y[i] = this->m_offset[1] + static_cast<float>(src[1]) * this->m_scale[1];
+			tile.z[i] = this->m_offset[2] + static_cast<float>(src[2]) * this->m_scale[2];
+			tile.w[i] = 1.0f;
+		}
+		PadTile(tile);
+	}
+
+	inline void QuantizedSource::Prefetch(size_t first, size_t count) const {
+		PrefetchRange(this->m_data + first * this->m_stride, count * this->m_stride * sizeof(uint16_t));
+	}
+
+	inline Vec3Source::Vec3Source(ConstVec3ArrayView points) : m_points(points) {}
+
+	inline void Vec3Source::operator()(PipelineTile& tile) const {
+		for (size_t i = 0; i < tile.count; ++i){
+			const size_t p = tile.first + i;
+			tile.index[i] = static_cast<uint32_t>(p);
+			tile.x[i] = this->m_points.X(p);
+			tile.y[i] = this->m_points.Y(p);
+			tile.z[i] = this->m_points.Z(p);
+			tile.w[i] = 1.0f;
+		}
+		PadTile(tile);
+	}
+
+	inline void Vec3Source::Prefetch(size_t first, size_t count) const {
+		if (count == 0) return;
+		PrefetchRange(&this->m_points.X(first), count * this->m_points.Stride() * sizeof(float));
+	}
+
+	inline Vector4Source::Vector4Source(const Vector4* points) : m_points(points) {}
+
+	inline void Vector4Source::operator()(PipelineTile& tile) const {
+		for (size_t i = 0; i < tile.count; ++i){
+			const Vector4& p = this->m_points[tile.first + i];
+			tile.index[i] = static_cast<uint32_t>(tile.first + i);
+			tile.x[i] = getXComponent(p);
+			tile.y[i] = getYComponent(p);
+			tile.z[i] = getZComponent(p);
+			tile.w[i] = getWComponent(p);
+		}
+		PadTile(tile);
+	}
+
+	inline void Vector4Source::Prefetch(size_t first, size_t count) const {
+		PrefetchRange(this->m_points + first, count * sizeof(Vector4));
+	}
+	///
+	///	Source stages end
+	///
+
+	///
+	///	Processing stages
+	///
+	///	p = mat * p for every lane, four rows per SimdFloat block.
+	class TransformStage {
+	private:
+		float m_mat[16];
+	public:
+		explicit TransformStage(const Matrix4x4& mat);
+
+		inline void operator()(PipelineTile& tile) const;
+	};
+
+	///	Clip-space depth range the frustum test assumes.
+	enum class ClipDepth {
+		ZeroToOne,		// D3D, Vulkan, Metal
+		MinusOneToOne	// OpenGL
+	};
+
+	///	Keeps points inside the clip volume (|x| <= w, |y| <= w and z in the
+	///	depth range); run it after a TransformStage with a view-projection
+	///	matrix. Survivors are compacted to the front of the tile in order.
+	class FrustumCullStage {
+	private:
+		ClipDepth m_depth;
+	public:
+		explicit FrustumCullStage(ClipDepth depth = ClipDepth::ZeroToOne);
+
+		inline void operator()(PipelineTile& tile) const;
+	};
+
+	inline TransformStage::TransformStage(const Matrix4x4& mat){
+		for (size_t k = 0; k < 16; ++k) this->m_mat[k] = getElement(mat, k / 4, k % 4);
+	}
+
+	inline void TransformStage::operator()(PipelineTile& tile) const {
+		const float* m = this->m_mat;
+		const SimdFloat m00(m[0]),	m01(m[1]),	m02(m[2]),	m03(m[3]);
+		const SimdFloat m10(m[4]),	m11(m[5]),	m12(m[6]),	m13(m[7]);
+		const SimdFloat m20(m[8]),	m21(m[9]),	m22(m[10]), m23(m[11]);
+		const SimdFloat m30(m[12]), m31(m[13]), m32(m[14]), m33(m[15]);
+
+		const size_t lanes = PaddedLanes(tile.count);
+		for (size_t i = 0; i < lanes; i += SimdFloat::Width){
+			const SimdFloat x = SimdFloat::LoadAligned(tile.x + i), y = SimdFloat::LoadAligned(tile.y + i);
+			const SimdFloat z = SimdFloat::LoadAligned(tile.z + i), w = SimdFloat::LoadAligned(tile.w + i);
+			MulAdd(m00, x, MulAdd(m01, y, MulAdd(m02, z, m03 * w))).StoreAligned(tile.x + i);
+			MulAdd(m10, x, MulAdd(m11, y, MulAdd(m12, z, m13 * w))).StoreAligned(tile.y + i);
+			MulAdd(m20, x, MulAdd(m21, y, MulAdd(m22, z, m23 * w))).StoreAligned(tile.z + i);
+			MulAdd(m30, x, MulAdd(m31, y, MulAdd(m32, z, m33 * w))).StoreAligned(tile.w + i);
+		}
+	}
+
+	inline FrustumCullStage::FrustumCullStage(ClipDepth depth) : m_depth(depth) {}
+
+	inline void FrustumCullStage::operator()(PipelineTile& tile) const {
+		const bool openGL = (this->m_depth == ClipDepth::MinusOneToOne);
+		size_t kept = 0;
+		for (size_t i = 0; i < tile.count; i += SimdFloat::Width){
+			const SimdFloat x = SimdFloat::LoadAligned(tile.x + i), y = SimdFloat::LoadAligned(tile.y + i);
+			const SimdFloat z = SimdFloat::LoadAligned(tile.z + i), w = SimdFloat::LoadAligned(tile.w + i);
+			const SimdFloat nearPlane = openGL ? -w : SimdFloat::Zero();
+			const SimdFloat inside = And(And(CmpLe(Abs(x), w), CmpLe(Abs(y), w)), And(CmpLe(z, w), CmpGe(z, nearPlane)));
+
+			const size_t lanes = MIN(SimdFloat::Width, tile.count - i);
+			int mask = MoveMask(inside) & ((1 << lanes) - 1);
+			if (mask == (1 << SimdFloat::Width) - 1 && kept == i){
+				kept += SimdFloat::Width;
+				continue;
+			}
+			// Compact in place; kept never passes i, so reads stay ahead of writes.
+			for (size_t l = 0; mask != 0; ++l, mask >>= 1){
+				if ((mask & 1) == 0) continue;
+				tile.index[kept] = tile.index[i + l];
+				tile.x[kept] = tile.x[i + l];
+				tile.y[kept] = tile.y[i + l];
+				tile.z[kept] = tile.z[i + l];
+				tile.w[kept] = tile.w[i + l];
+				++kept;
+			}
+		}
+		tile.count = kept;
+		PadTile(tile);
+	}
+	///
+	///	Processing stages end
+	///
+
+	///
+	///	Sink stages
+	///
+	///	Sinks append a tile's survivors to a shared output through an atomic
+	///	cursor: each tile reserves one contiguous range, so the order inside
+	///	a tile is kept but tiles land in completion order. indices (optional)
+	///	receives each written point's source index.
+	///
+	///	Four binary16 values per point (x, y, z, w); uses F16C when available.
+	class PackHalfStage {
+	private:
+		uint16_t*			 m_out;
+		uint32_t*			 m_indices;
+		std::atomic<size_t>* m_cursor;
+	public:
+		PackHalfStage(uint16_t* out, uint32_t* indices, std::atomic<size_t>& cursor);
+
+		inline void operator()(PipelineTile& tile) const;
+	};
+
+	///	Three floats per point after the perspective divide (x, y, z) / w.
+	class PackFloat3Stage {
+	private:
+		float*				 m_out;
+		uint32_t*			 m_indices;
+		std::atomic<size_t>* m_cursor;
+	public:
+		PackFloat3Stage(float* out, uint32_t* indices, std::atomic<size_t>& cursor);
+
+		inline void operator()(PipelineTile& tile) const;
+	};
+
+	inline PackHalfStage::PackHalfStage(uint16_t* out, uint32_t* indices, std::atomic<size_t>& cursor)
+	: m_out(out), m_indices(indices), m_cursor(&cursor) {}
+
+	inline void PackHalfStage::operator()(PipelineTile& tile) const {
+		const size_t base = this->m_cursor->fetch_add(tile.count, std::memory_order_relaxed);
+		uint16_t* dst = this->m_out + base * 4;
+		size_t i = 0;
+	#if defined(__F16C__)
+		for (; i + 4 <= tile.count; i += 4){
+			__m128 p0 = _mm_load_ps(tile.x + i), p1 = _mm_load_ps(tile.y + i);
+			__m128 p2 = _mm_load_ps(tile.z + i), p3 = _mm_load_ps(tile.w + i);
+			_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (i + 0) * 4), _mm_cvtps_ph(p0, _MM_FROUND_TO_NEAREST_INT));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (i + 1) * 4), _mm_cvtps_ph(p1, _MM_FROUND_TO_NEAREST_INT));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (i + 2) * 4), _mm_cvtps_ph(p2, _MM_FROUND_TO_NEAREST_INT));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + (i + 3) * 4), _mm_cvtps_ph(p3, _MM_FROUND_TO_NEAREST_INT));
+		}
+	#endif
+		for (; i < tile.count; ++i){
+			dst[i * 4 + 0] = FloatToHalf(tile.x[i]);
+			dst[i * 4 + 1] = FloatToHalf(tile.y[i]);
+			dst[i * 4 + 2] = FloatToHalf(tile.z[i]);
+			dst[i * 4 + 3] = FloatToHalf(tile.w[i]);
+		}
+		if (this->m_indices != nullptr)
+			for (size_t k = 0; k < tile.count; ++k) this->m_indices[base + k] = tile.index[k];
+	}
+
+	inline PackFloat3Stage::PackFloat3Stage(float* out, uint32_t* indices, std::atomic<size_t>& cursor)
+	: m_out(out), m_indices(indices), m_cursor(&cursor) {}
+
+	inline void PackFloat3Stage::operator()(PipelineTile& tile) const {
+		const size_t base = this->m_cursor->fetch_add(tile.count, std::memory_order_relaxed);
+		float* dst = this->m_out + base * 3;
+
+		// Divide in place first; the tile is thrown away after the sink.
+		const size_t lanes = PaddedLanes(tile.count);
+		for (size_t i = 0; i < lanes; i += SimdFloat::Width){
+			const SimdFloat invW = SimdFloat(1.0f) / SimdFloat::LoadAligned(tile.w + i);
+			(SimdFloat::LoadAligned(tile.x + i) * invW).StoreAligned(tile.x + i);
+			(SimdFloat::LoadAligned(tile.y + i) * invW).StoreAligned(tile.y + i);
+			(SimdFloat::LoadAligned(tile.z + i) * invW).StoreAligned(tile.z + i);
+		}
+		for (size_t i = 0; i < tile.count; ++i){
+			dst[i * 3 + 0] = tile.x[i];
+			dst[i * 3 + 1] = tile.y[i];
+			dst[i * 3 + 2] = tile.z[i];
+		}
+		if (this->m_indices != nullptr)
+			for (size_t k = 0; k < tile.count; ++k) this->m_indices[base + k] = tile.index[k];
+	}
+	///
+	///	Sink stages end
+	///
+
+	///
+	///	Definition of PipelineStages
+	///
+	///	Recursive stage list behind Pipeline: holds the first stage and the
+	///	rest, and runs them in order. seconds, when not null, points at the
+	///	timer slot of the first stage.
+	///
+	template<typename Stage>
+	inline void RunPipelineStage(const Stage& stage, PipelineTile& tile, double* seconds){
+		if (seconds == nullptr){
+			stage(tile);
+			return;
+		}
+		const auto start = std::chrono::steady_clock::now();
+		stage(tile);
+		*seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	template<typename... Stages>
+	struct PipelineStages {
+		inline void Run(PipelineTile&, double*) const {}
+	};
+
+	template<typename Head, typename... Tail>
+	struct PipelineStages<Head, Tail...> {
+		Head					 m_head;
+		PipelineStages<Tail...> m_tail;
+
+		explicit PipelineStages(const Head& head, const Tail&... tail) : m_head(head), m_tail(tail...) {}
+
+		inline void Run(PipelineTile& tile, double* seconds) const {
+			RunPipelineStage(this->m_head, tile, seconds);
+			this->m_tail.Run(tile, (seconds != nullptr) ? seconds + 1 : nullptr);
+		}
+	};
+	///
+	///	Definition of PipelineStages end
+	///
+
+	///
+	///	Definition of Pipeline class
+	///
+	///	A source followed by any number of stages, composed at compile time:
+	///	a stage is any copyable type with operator()(PipelineTile&) const.
+	///	Run splits the input into tiles, hands contiguous runs of tiles to
+	///	the workers and pushes each tile through every stage before the next
+	///	one is loaded, so intermediate data never leaves cache. While a tile
+	///	runs, the source prefetches the next tile's input, which keeps one
+	///	tile in flight and one streaming in.
+	///
+	template<typename Source, typename... Stages>
+	class Pipeline {
+	private:
+		PipelineStages<Source, Stages...> m_stages;
+	public:
+		static const size_t StageCount = 1 + sizeof...(Stages);
+
+		explicit Pipeline(const Source& source, const Stages&... stages);
+
+		///	Pushes points [0, count) through the pipeline and returns how
+		///	many survived every stage. stats, if given, is overwritten.
+		inline size_t Run(size_t count, PipelineStats* stats = nullptr, size_t threadCount = 0) const;
+
+		~Pipeline() = default;
+	};
+	///
+	///	Definition of Pipeline class end
+	///
+
+	///
+	///	Declaration of Pipeline methods
+	///
+	template<typename Source, typename... Stages>
+	inline Pipeline<Source, Stages...>::Pipeline(const Source& source, const Stages&... stages)
+	: m_stages(source, stages...) {}
+
+	template<typename Source, typename... Stages>
+	inline size_t Pipeline<Source, Stages...>::Run(size_t count, PipelineStats* stats, size_t threadCount) const {
+		FGML_SCOPED_TIMER(PipelineRun);
+		assert(count <= std::numeric_limits<uint32_t>::max() && "Too many points for 32-bit indices");
+		const size_t tiles	= (count + PIPELINE_TILE_SIZE - 1) / PIPELINE_TILE_SIZE;
+		const size_t chunks = ChunkCount(tiles, PIPELINE_MIN_TILES, threadCount);
+
+		std::vector<double> seconds((stats != nullptr) ? chunks * StageCount : 0, 0.0);
+		std::vector<size_t> survivors(chunks, 0);
+
+		ParallelFor(tiles, PIPELINE_MIN_TILES, [&](size_t begin, size_t end, size_t chunk){
+			// On the worker's stack: alignas is honoured there, whereas plain new
+			// only guarantees over-alignment from C++17 on.
+			PipelineTile tile;
+			double* local = (stats != nullptr) ? &seconds[chunk * StageCount] : nullptr;
+
+			for (size_t t = begin; t < end; ++t){
+				tile.first = t * PIPELINE_TILE_SIZE;
+				tile.count = MIN(PIPELINE_TILE_SIZE, count - tile.first);
+				if (t + 1 < end){
+					const size_t next = tile.first + tile.count;
+					this->m_stages.m_head.Prefetch(next, MIN(PIPELINE_TILE_SIZE, count - next));
+				}
+				this->m_stages.Run(tile, local);
+				survivors[chunk] += tile.count;
+			}
+		}, threadCount);
+
+		size_t total = 0;
+		for (size_t c = 0; c < chunks; ++c) total += survivors[c];
+
+		if (stats != nullptr){
+			stats->stageSeconds.assign(StageCount, 0.0);
+			for (size_t c = 0; c < chunks; ++c)
+				for (size_t s = 0; s < StageCount; ++s) stats->stageSeconds[s] += seconds[c * StageCount + s];
+			stats->tiles  = tiles;
+			stats->input  = count;
+			stats->output = total;
+		}
+		return total;
+	}
+	///
+	///	Declaration of Pipeline methods end
+	///
+
+	///	Deduces the stage types: MakePipeline(source, stage0, stage1, ...).
+	template<typename Source, typename... Stages>
+	inline Pipeline<Source, Stages...> MakePipeline(const Source& source, const Stages&... stages){
+		return Pipeline<Source, Stages...>(source, stages...);
+	}
+};
+
+#endif // FGML_PIPELINE_HPP_
\ No newline at end of file
@@ -0,0 +1,367 @@
+#ifndef FGML_SIMD_HPP_
+#define FGML_SIMD_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Macros.hpp"
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define FGML_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define FGML_SIMD_SSE 1
+#endif
+
+namespace FGML {
+	///
+	///	Definition of SimdFloat class
+	///
+	///	Widest float register the target was compiled for: 8 lanes with AVX,
+	///	4 with SSE2, otherwise a single scalar lane. Comparisons return lane
+	///	masks (all bits set or clear) that feed Select, And and MoveMask.
+	///
+	class SimdFloat {
+	public:
+	#if defined(FGML_SIMD_AVX)
+		using Register = __m256;
+		static const size_t Width = 8;
+	#elif defined(FGML_SIMD_SSE)
+		using Register = __m128;
+		static const size_t Width = 4;
+	#else
+		using Register = float;
+		static const size_t Width = 1;
+	#endif
+	private:
+		Register m_v;
+	public:
+		SimdFloat() = default;
+
+		SimdFloat(float scalar);
+	#if defined(FGML_SIMD_AVX) || defined(FGML_SIMD_SSE)
+		explicit SimdFloat(Register reg);
+	#endif
+
+		inline Register Native(void) const;
+
+		static inline SimdFloat Zero(void);
+		static inline SimdFloat Load(const float* src);
+		static inline SimdFloat LoadAligned(const float* src);
+		static inline SimdFloat Gather(const float* base, const uint32_t* indices);
+
+		inline void Store(float* dst) const;
+		inline void StoreAligned(float* dst) const;
+
+		friend inline SimdFloat operator-(const SimdFloat& a);
+		friend inline SimdFloat operator+(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat operator-(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat operator*(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat operator/(const SimdFloat& a, const SimdFloat& b);
+
+		inline void operator+=(const SimdFloat& a);
+		inline void operator-=(const SimdFloat& a);
+		inline void operator*=(const SimdFloat& a);
+
+		friend inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat Sqrt(const SimdFloat& a);
+		friend inline SimdFloat Abs(const SimdFloat& a);
+		friend inline SimdFloat Floor(const SimdFloat& a);
+		friend inline SimdFloat MulAdd(const SimdFloat& a, const SimdFloat& b, const SimdFloat& c);
+
+		friend inline SimdFloat CmpLt(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat CmpLe(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat CmpGt(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat CmpGe(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat CmpEq(const SimdFloat& a, const SimdFloat& b);
+
+		friend inline SimdFloat And(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat Or(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat AndNot(const SimdFloat& a, const SimdFloat& b);
+		friend inline SimdFloat Select(const SimdFloat& mask, const SimdFloat& a, const SimdFloat& b);
+
+		friend inline int		MoveMask(const SimdFloat& mask);
+
+		friend inline SimdFloat Exp2Int(const SimdFloat& n);
+		friend inline SimdFloat SplitExponent(const SimdFloat& x, SimdFloat& exponent);
+
+		~SimdFloat() = default;
+	};
+	///
+	///	Definition of SimdFloat class end
+	///
+
+	///
+	///	Declaration of SimdFloat methods
+	///
+	inline float SimdMaskBits(bool set){
+		const uint32_t bits = set ? 0xFFFFFFFFu : 0u;
+		float mask;
+		std::memcpy(&mask, &bits, sizeof(mask));
+		return mask;
+	}
+
+	inline uint32_t SimdBits(float value){
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	inline float SimdFromBits(uint32_t bits){
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+#if defined(FGML_SIMD_AVX)
+	inline SimdFloat::SimdFloat(float scalar) : m_v(_mm256_set1_ps(scalar)) {}
+	inline SimdFloat::SimdFloat(Register reg) : m_v(reg) {}
+
+	inline SimdFloat SimdFloat::Zero(void)						  { return SimdFloat(_mm256_setzero_ps()); }
+	inline SimdFloat SimdFloat::Load(const float* src)			  { return SimdFloat(_mm256_loadu_ps(src)); }
+	inline SimdFloat SimdFloat::LoadAligned(const float* src)	  { return SimdFloat(_mm256_load_ps(src)); }
+	inline void		 SimdFloat::Store(float* dst) const			  { _mm256_storeu_ps(dst, this->m_v); }
+	inline void		 SimdFloat::StoreAligned(float* dst) const	  { _mm256_store_ps(dst, this->m_v); }
+
+	inline SimdFloat operator+(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_add_ps(a.m_v, b.m_v)); }
+	inline SimdFloat operator-(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_sub_ps(a.m_v, b.m_v)); }
+	inline SimdFloat operator*(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_mul_ps(a.m_v, b.m_v)); }
+	inline SimdFloat operator/(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_div_ps(a.m_v, b.m_v)); }
+
+	inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_min_ps(a.m_v, b.m_v)); }
+	inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_max_ps(a.m_v, b.m_v)); }
+	inline SimdFloat Sqrt(const SimdFloat& a)					{ return SimdFloat(_mm256_sqrt_ps(a.m_v)); }
+	inline SimdFloat Floor(const SimdFloat& a)					{ return SimdFloat(_mm256_floor_ps(a.m_v)); }
+
+	inline SimdFloat MulAdd(const SimdFloat& a, const SimdFloat& b, const SimdFloat& c){
+	#if defined(__FMA__)
+		return SimdFloat(_mm256_fmadd_ps(a.m_v, b.m_v, c.m_v));
+	#else
+		return SimdFloat(_mm256_add_ps(_mm256_mul_ps(a.m_v, b.m_v), c.m_v));
+	#endif
+	}
+
+	inline SimdFloat CmpLt(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_cmp_ps(a.m_v, b.m_v, _CMP_LT_OQ)); }
+	inline SimdFloat CmpLe(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_cmp_ps(a.m_v, b.m_v, _CMP_LE_OQ)); }
+	inline SimdFloat CmpGt(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_cmp_ps(a.m_v, b.m_v, _CMP_GT_OQ)); }
+	inline SimdFloat CmpGe(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_cmp_ps(a.m_v, b.m_v, _CMP_GE_OQ)); }
+	inline SimdFloat CmpEq(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_cmp_ps(a.m_v, b.m_v, _CMP_EQ_OQ)); }
+
+	inline SimdFloat And(const SimdFloat& a, const SimdFloat& b)   { return SimdFloat(_mm256_and_ps(a.m_v, b.m_v)); }
+	inline SimdFloat Or(const SimdFloat& a, const SimdFloat& b)	   { return SimdFloat(_mm256_or_ps(a.m_v, b.m_v)); }
+	inline SimdFloat AndNot(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm256_andnot_ps(a.m_v, b.m_v)); }
+
+	inline SimdFloat Select(const SimdFloat& mask, const SimdFloat& a, const SimdFloat& b){
+		return SimdFloat(_mm256_blendv_ps(b.m_v, a.m_v, mask.m_v));
+	}
+
+	inline int MoveMask(const SimdFloat& mask){ return _mm256_movemask_ps(mask.m_v); }
+
+	inline SimdFloat Exp2Int(const SimdFloat& n){
+		const __m256i biased = _mm256_cvttps_epi32(_mm256_add_ps(n.m_v, _mm256_set1_ps(127.0f)));
+	#if defined(__AVX2__)
+		return SimdFloat(_mm256_castsi256_ps(_mm256_slli_epi32(biased, 23)));
+	#else
+		// Plain AVX has no 256-bit integer shifts; shift each half.
+		const __m128i lo = _mm_slli_epi32(_mm256_castsi256_si128(biased), 23);
+		const __m128i hi = _mm_slli_epi32(_mm256_extractf128_si256(biased, 1), 23);
+		return SimdFloat(_mm256_castsi256_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1)));
+	#endif
+	}
+
+	inline SimdFloat SplitExponent(const SimdFloat& x, SimdFloat& exponent){
+		const __m256i bits = _mm256_castps_si256(x.m_v);
+	#if defined(__AVX2__)
+		const __m256i field = _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xFF));
+	#else
+		const __m128i lo = _mm_and_si128(_mm_srli_epi32(_mm256_castsi256_si128(bits), 23), _mm_set1_epi32(0xFF));
+		const __m128i hi = _mm_and_si128(_mm_srli_epi32(_mm256_extractf128_si256(bits, 1), 23), _mm_set1_epi32(0xFF));
+		const __m256i field = _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1);
+	#endif
+		exponent = SimdFloat(_mm256_sub_ps(_mm256_cvtepi32_ps(field), _mm256_set1_ps(126.0f)));
+		const __m256 keep = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(0x807FFFFFu)));
+		const __m256 half = _mm256_castsi256_ps(_mm256_set1_epi32(0x3F000000));
+		return SimdFloat(_mm256_or_ps(_mm256_and_ps(x.m_v, keep), half));
+	}
+#elif defined(FGML_SIMD_SSE)
+	inline SimdFloat::SimdFloat(float scalar) : m_v(_mm_set1_ps(scalar)) {}
+	inline SimdFloat::SimdFloat(Register reg) : m_v(reg) {}
+
+	inline SimdFloat SimdFloat::Zero(void)						  { return SimdFloat(_mm_setzero_ps()); }
+	inline SimdFloat SimdFloat::Load(const float* src)			  { return SimdFloat(_mm_loadu_ps(src)); }
+	inline SimdFloat SimdFloat::LoadAligned(const float* src)	  { return SimdFloat(_mm_load_ps(src)); }
+	inline void		 SimdFloat::Store(float* dst) const			  { _mm_storeu_ps(dst, this->m_v); }
+	inline void		 SimdFloat::StoreAligned(float* dst) const	  { _mm_store_ps(dst, this->m_v); }
+
+	inline SimdFloat operator+(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_add_ps(a.m_v, b.m_v)); }
+	inline SimdFloat operator-(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_sub_ps(a.m_v, b.m_v)); }
+	inline SimdFloat operator*(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_mul_ps(a.m_v, b.m_v)); }
+	inline SimdFloat operator/(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_div_ps(a.m_v, b.m_v)); }
+
+	inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_min_ps(a.m_v, b.m_v)); }
+	inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_max_ps(a.m_v, b.m_v)); }
+	inline SimdFloat Sqrt(const SimdFloat& a)					{ return SimdFloat(_mm_sqrt_ps(a.m_v)); }
+
+	inline SimdFloat Floor(const SimdFloat& a){
+		// Truncate, then step down where truncation rounded a negative value up.
+		const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.m_v));
+		const __m128 roundedUp = _mm_cmpgt_ps(truncated, a.m_v);
+		return SimdFloat(_mm_sub_ps(truncated, _mm_and_ps(roundedUp, _mm_set1_ps(1.0f))));
+	}
+
+	inline SimdFloat MulAdd(const SimdFloat& a, const SimdFloat& b, const SimdFloat& c){
+		return SimdFloat(_mm_add_ps(_mm_mul_ps(a.m_v, b.m_v), c.m_v));
+	}
+
+	inline SimdFloat CmpLt(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_cmplt_ps(a.m_v, b.m_v)); }
+	inline SimdFloat CmpLe(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_cmple_ps(a.m_v, b.m_v)); }
+	inline SimdFloat CmpGt(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_cmpgt_ps(a.m_v, b.m_v)); }
+	inline SimdFloat CmpGe(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_cmpge_ps(a.m_v, b.m_v)); }
+	inline SimdFloat CmpEq(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_cmpeq_ps(a.m_v, b.m_v)); }
+
+	inline SimdFloat And(const SimdFloat& a, const SimdFloat& b)   { return SimdFloat(_mm_and_ps(a.m_v, b.m_v)); }
+	inline SimdFloat Or(const SimdFloat& a, const SimdFloat& b)	   { return SimdFloat(_mm_or_ps(a.m_v, b.m_v)); }
+	inline SimdFloat AndNot(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(_mm_andnot_ps(a.m_v, b.m_v)); }
+
+	inline SimdFloat Select(const SimdFloat& mask, const SimdFloat& a, const SimdFloat& b){
+		return SimdFloat(_mm_or_ps(_mm_and_ps(mask.m_v, a.m_v), _mm_andnot_ps(mask.m_v, b.m_v)));
+	}
+
+	inline int MoveMask(const SimdFloat& mask){ return _mm_movemask_ps(mask.m_v); }
+
+	inline SimdFloat Exp2Int(const SimdFloat& n){
+		const __m128i biased = _mm_cvttps_epi32(_mm_add_ps(n.m_v, _mm_set1_ps(127.0f)));
+		return SimdFloat(_mm_castsi128_ps(_mm_slli_epi32(biased, 23)));
+	}
+
+	inline SimdFloat SplitExponent(const SimdFloat& x, SimdFloat& exponent){
+		const __m128i field = _mm_and_si128(_mm_srli_epi32(_mm_castps_si128(x.m_v), 23), _mm_set1_epi32(0xFF));
+		exponent = SimdFloat(_mm_sub_ps(_mm_cvtepi32_ps(field), _mm_set1_ps(126.0f)));
+		const __m128 keep = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x807FFFFFu)));
+		const __m128 half = _mm_castsi128_ps(_mm_set1_epi32(0x3F000000));
+		return SimdFloat(_mm_or_ps(_mm_and_ps(x.m_v, keep), half));
+	}
+#else
+	inline SimdFloat::SimdFloat(float scalar) : m_v(scalar) {}
+
+	inline SimdFloat SimdFloat::Zero(void)						  { return SimdFloat(0.0f); }
+	inline SimdFloat SimdFloat::Load(const float* src)			  { return SimdFloat(*src); }
+	inline SimdFloat SimdFloat::LoadAligned(const float* src)	  { return SimdFloat(*src); }
+	inline void		 SimdFloat::Store(float* dst) const			  { *dst = this->m_v; }
+	inline void		 SimdFloat::StoreAligned(float* dst) const	  { *dst = this->m_v; }
+
+	inline SimdFloat operator+(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(a.m_v + b.m_v); }
+	inline SimdFloat operator-(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(a.m_v - b.m_v); }
+	inline SimdFloat operator*(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(a.m_v * b.m_v); }
+	inline SimdFloat operator/(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(a.m_v / b.m_v); }
+
+	inline SimdFloat Min(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(MIN(a.m_v, b.m_v)); }
+	inline SimdFloat Max(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(MAX(a.m_v, b.m_v)); }
+	inline SimdFloat Sqrt(const SimdFloat& a)					{ return SimdFloat(std::sqrt(a.m_v)); }
+	inline SimdFloat Floor(const SimdFloat& a)					{ return SimdFloat(std::floor(a.m_v)); }
+
+	inline SimdFloat MulAdd(const SimdFloat& a, const SimdFloat& b, const SimdFloat& c){
+		return SimdFloat(a.m_v * b.m_v + c.m_v);
+	}
+
+	inline SimdFloat CmpLt(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(SimdMaskBits(a.m_v <  b.m_v)); }
+	inline SimdFloat CmpLe(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(SimdMaskBits(a.m_v <= b.m_v)); }
+	inline SimdFloat CmpGt(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(SimdMaskBits(a.m_v >  b.m_v)); }
+	inline SimdFloat CmpGe(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(SimdMaskBits(a.m_v >= b.m_v)); }
+	inline SimdFloat CmpEq(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(SimdMaskBits(a.m_v == b.m_v)); }
+
+	inline SimdFloat And(const SimdFloat& a, const SimdFloat& b)   { return SimdFloat(SimdFromBits(SimdBits(a.m_v) & SimdBits(b.m_v))); }
+	inline SimdFloat Or(const SimdFloat& a, const SimdFloat& b)	   { return SimdFloat(SimdFromBits(SimdBits(a.m_v) | SimdBits(b.m_v))); }
+	inline SimdFloat AndNot(const SimdFloat& a, const SimdFloat& b){ return SimdFloat(SimdFromBits(~SimdBits(a.m_v) & SimdBits(b.m_v))); }
+
+	inline SimdFloat Select(const SimdFloat& mask, const SimdFloat& a, const SimdFloat& b){
+		return SimdFloat((SimdBits(mask.m_v) >> 31) ? a.m_v : b.m_v);
+	}
+
+	inline int MoveMask(const SimdFloat& mask){ return static_cast<int>(SimdBits(mask.m_v) >> 31); }
+
+	inline SimdFloat Exp2Int(const SimdFloat& n){
+		return SimdFloat(SimdFromBits(static_cast<uint32_t>(static_cast<int32_t>(n.m_v) + 127) << 23));
+	}
+
+	inline SimdFloat SplitExponent(const SimdFloat& x, SimdFloat& exponent){
+		const uint32_t bits = SimdBits(x.m_v);
+		exponent = SimdFloat(static_cast<float>(static_cast<int32_t>((bits >> 23) & 0xFFu) - 126));
+		return SimdFloat(SimdFromBits((bits & 0x807FFFFFu) | 0x3F000000u));
+	}
+#endif
+
+	inline SimdFloat::Register SimdFloat::Native(void) const {
+		return this->m_v;
+	}
+
+	///	Lanes are inserted in registers: going through a stack array stalls
+	///	on store forwarding when the wide load reads the narrow stores.
+	inline SimdFloat SimdFloat::Gather(const float* base, const uint32_t* indices){
+	#if defined(FGML_SIMD_AVX)
+		return SimdFloat(_mm256_set_ps(base[indices[7]], base[indices[6]], base[indices[5]], base[indices[4]],
+									   base[indices[3]], base[indices[2]], base[indices[1]], base[indices[0]]));
+	#elif defined(FGML_SIMD_SSE)
+		return SimdFloat(_mm_set_ps(base[indices[3]], base[indices[2]], base[indices[1]], base[indices[0]]));
+	#else
+		return SimdFloat(base[indices[0]]);
+	#endif
+	}
+
+	inline SimdFloat operator-(const SimdFloat& a){
+		return SimdFloat::Zero() - a;
+	}
+
+	inline SimdFloat Abs(const SimdFloat& a){
+		return Max(a, -a);
+	}
+
+	inline void SimdFloat::operator+=(const SimdFloat& a){ *this = *this + a; }
+	inline void SimdFloat::operator-=(const SimdFloat& a){ *this = *this - a; }
+	inline void SimdFloat::operator*=(const SimdFloat& a){ *this = *this * a; }
+	///
+	///	Declaration of SimdFloat methods end
+	///
+
+	///
+	///	Scalar twins, so templates can be written once for float and SimdFloat
+	///
+	inline float Min(float a, float b)				 { return MIN(a, b); }
+	inline float Max(float a, float b)				 { return MAX(a, b); }
+	inline float Sqrt(float a)						 { return std::sqrt(a); }
+	inline float Abs(float a)						 { return std::fabs(a); }
+	inline float Floor(float a)						 { return std::floor(a); }
+	inline float MulAdd(float a, float b, float c)	 { return a * b + c; }
+
+	inline float CmpLt(float a, float b)			 { return SimdMaskBits(a <  b); }
+	inline float CmpLe(float a, float b)			 { return SimdMaskBits(a <= b); }
+	inline float CmpGt(float a, float b)			 { return SimdMaskBits(a >  b); }
+	inline float CmpGe(float a, float b)			 { return SimdMaskBits(a >= b); }
+	inline float CmpEq(float a, float b)			 { return SimdMaskBits(a == b); }
+
+	inline float And(float a, float b)				 { return SimdFromBits(SimdBits(a) & SimdBits(b)); }
+	inline float Or(float a, float b)				 { return SimdFromBits(SimdBits(a) | SimdBits(b)); }
+	inline float AndNot(float a, float b)			 { return SimdFromBits(~SimdBits(a) & SimdBits(b)); }
+	inline float Select(float mask, float a, float b){ return (SimdBits(mask) >> 31) ? a : b; }
+
+	///	2^n for integral n in [-126, 127], built directly in the exponent field.
+	inline float Exp2Int(float n){
+		return SimdFromBits(static_cast<uint32_t>(static_cast<int32_t>(n) + 127) << 23);
+	}
+
+	///	x = mantissa * 2^exponent with the mantissa in [0.5, 1); normal x only.
+	inline float SplitExponent(float x, float& exponent){
+		const uint32_t bits = SimdBits(x);
+		exponent = static_cast<float>(static_cast<int32_t>((bits >> 23) & 0xFFu) - 126);
+		return SimdFromBits((bits & 0x807FFFFFu) | 0x3F000000u);
+	}
+	///
+	///	Scalar twins end
+	///
+};
+
+#endif // FGML_SIMD_HPP_
\ No newline at end of file
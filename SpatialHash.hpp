@@ -0,0 +1,445 @@
+#ifndef FGML_SPATIALHASH_HPP_
+#define FGML_SPATIALHASH_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "Vector3.hpp"
+#include "Views.hpp"
+#include "Morton.hpp"
+
+namespace FGML {
+	///
+	///	Definition of SpatialHash class
+	///
+	///	Uniform grid hashed into a power-of-two bucket table. Points are
+	///	radix-sorted by bucket so every bucket is one contiguous SoA range,
+	///	and all distance tests compare squared distances. The sort is
+	///	stable, so points in a bucket, and therefore query results, stay in
+	///	input order whatever the thread count.
+	///
+	class SpatialHash {
+	private:
+		float						 m_cellSize;
+		float						 m_invCellSize;
+		size_t						 m_tableMask;
+		size_t						 m_count;
+
+		std::vector<uint32_t>		 m_cellStart;	// tableSize + 1 offsets
+		std::vector<uint32_t>		 m_index;		// original point index per slot
+		std::vector<float>			 m_x;
+		std::vector<float>			 m_y;
+		std::vector<float>			 m_z;
+		int32_t						 m_cellMin[3];	// cell bounds of the points
+		int32_t						 m_cellMax[3];
+
+		std::vector<uint32_t>		 m_bucketOf;	// build scratch: bucket per slot after sorting
+		std::vector<uint32_t>		 m_order;		// build scratch: original index per slot
+
+		inline int32_t  CellCoord(float value) const;
+		inline bool		CellRange(float lo, float hi, size_t axis, int32_t& first, int32_t& last) const;
+		inline uint32_t Bucket(int32_t ix, int32_t iy, int32_t iz) const;
+		inline void		Reserve(size_t count);
+
+		inline size_t RadiusInto(const Vector3& center, float radius,
+								 std::vector<uint32_t>& out,
+								 std::vector<uint32_t>& bucketScratch) const;
+		inline size_t KNearestInto(const Vector3& center, size_t k, float maxRadius,
+								   uint32_t* outIndices, float* outDistSq,
+								   std::vector<std::pair<float, uint32_t>>& heap,
+								   std::vector<uint64_t>& visitedBits,
+								   std::vector<uint32_t>& visitedBuckets) const;
+	public:
+		explicit SpatialHash(float cellSize);
+
+		SpatialHash(const SpatialHash&) = delete;
+		SpatialHash& operator=(const SpatialHash&) = delete;
+
+		inline void Build(ConstVec3ArrayView points, size_t threadCount = 0);
+		inline void Build(const Vector3* points, size_t count, size_t threadCount = 0);
+
+		inline size_t QueryRadius(const Vector3& center, float radius, std::vector<uint32_t>& out) const;
+		inline void	  QueryRadiusBatch(ConstVec3ArrayView centers, float radius,
+									   std::vector<uint32_t>& offsets, std::vector<uint32_t>& indices,
+									   size_t threadCount = 0) const;
+		inline void	  QueryRadiusBatch(const Vector3* centers, size_t count, float radius,
+									   std::vector<uint32_t>& offsets, std::vector<uint32_t>& indices,
+									   size_t threadCount = 0) const;
+
+		inline size_t QueryKNearest(const Vector3& center, size_t k, float maxRadius,
+									uint32_t* outIndices, float* outDistSq) const;
+		inline void	  QueryKNearestBatch(ConstVec3ArrayView centers, size_t k, float maxRadius,
+										 uint32_t* outIndices, float* outDistSq,
+										 size_t threadCount = 0) const;
+		inline void	  QueryKNearestBatch(const Vector3* centers, size_t count, size_t k, float maxRadius,
+										 uint32_t* outIndices, float* outDistSq,
+										 size_t threadCount = 0) const;
+
+		inline size_t Size(void) const;
+		inline float  CellSize(void) const;
+
+		~SpatialHash() = default;
+	};
+	///
+	///	Definition of SpatialHash class end
+	///
+
+	///
+	///	Declaration of SpatialHash methods
+	///
+	inline SpatialHash::SpatialHash(float cellSize)
+	: m_cellSize(cellSize), m_invCellSize(1.0f / cellSize), m_tableMask(0), m_count(0),
+	  m_cellMin{ 0, 0, 0 }, m_cellMax{ 0, 0, 0 } {
+		assert(cellSize > 0.0f && "Cell size must be positive");
+	}
+
+	inline int32_t SpatialHash::CellCoord(float value) const {
+		return static_cast<int32_t>(std::floor(value * this->m_invCellSize));
+	}
+
+	///	Cells covering [lo, hi] on one axis, clipped to the occupied cells;
+	///	false when the span misses them. Clipping happens before the integer
+	///	conversion, so infinite or huge spans are safe.
+	inline bool SpatialHash::CellRange(float lo, float hi, size_t axis, int32_t& first, int32_t& last) const {
+		const double a = std::floor(lo * this->m_invCellSize);
+		const double b = std::floor(hi * this->m_invCellSize);
+		if (!(a <= this->m_cellMax[axis] && b >= this->m_cellMin[axis])) return false;
+		first = static_cast<int32_t>(MAX(a, static_cast<double>(this->m_cellMin[axis])));
+		last  = static_cast<int32_t>(MIN(b, static_cast<double>(this->m_cellMax[axis])));
+		return true;
+	}
+
+	inline uint32_t SpatialHash::Bucket(int32_t ix, int32_t iy, int32_t iz) const {
+		const uint32_t h = (static_cast<uint32_t>(ix) * 73856093u)
+						 ^ (static_cast<uint32_t>(iy) * 19349663u)
+						 ^ (static_cast<uint32_t>(iz) * 83492791u);
+		return h & static_cast<uint32_t>(this->m_tableMask);
+	}
+
+	inline void SpatialHash::Reserve(size_t count){
+		size_t tableSize = 64;
+		while (tableSize < 2 * count) tableSize <<= 1;
+		this->m_tableMask = tableSize - 1;
+
+		this->m_cellStart.resize(tableSize + 1);
+		this->m_index.resize(count);
+		this->m_x.resize(count);
+		this->m_y.resize(count);
+		this->m_z.resize(count);
+		this->m_bucketOf.resize(count);
+		this->m_order.resize(count);
+	}
+
+	inline void SpatialHash::Build(ConstVec3ArrayView points, size_t threadCount){
+		FGML_SCOPED_TIMER(SpatialHashBuild);
+		const size_t count = points.size();
+		assert(count < std::numeric_limits<uint32_t>::max() && "Too many points for 32-bit indices");
+
+		this->Reserve(count);
+		this->m_count = count;
+
+		const size_t tableSize = this->m_tableMask + 1;
+		const size_t minChunk = 16384;
+
+		// Bucket keys; each chunk also records the cell bounds of its points
+		// for the query limits.
+		const size_t pointChunks = ChunkCount(count, minChunk, threadCount);
+		std::vector<int32_t> chunkBounds(pointChunks * 6);
+		ParallelFor(count, minChunk, [&](size_t begin, size_t end, size_t c){
+			int32_t* bounds = &chunkBounds[c * 6];
+			bounds[0] = bounds[1] = bounds[2] = std::numeric_limits<int32_t>::max();
+			bounds[3] = bounds[4] = bounds[5] = std::numeric_limits<int32_t>::min();
+			for (size_t i = begin; i < end; ++i){
+				const int32_t cell[3] = { this->CellCoord(points.X(i)), this->CellCoord(points.Y(i)), this->CellCoord(points.Z(i)) };
+				for (size_t a = 0; a < 3; ++a){
+					bounds[a]	  = MIN(bounds[a], cell[a]);
+					bounds[a + 3] = MAX(bounds[a + 3], cell[a]);
+				}
+				this->m_bucketOf[i] = this->Bucket(cell[0], cell[1], cell[2]);
+				this->m_order[i]	= static_cast<uint32_t>(i);
+			}
+		}, threadCount);
+
+		for (size_t a = 0; a < 3; ++a){
+			this->m_cellMin[a] = 0;
+			this->m_cellMax[a] = 0;
+		}
+		for (size_t c = 0; c < pointChunks; ++c){
+			for (size_t a = 0; a < 3; ++a){
+				this->m_cellMin[a] = (c == 0) ? chunkBounds[a]	   : MIN(this->m_cellMin[a], chunkBounds[c * 6 + a]);
+				this->m_cellMax[a] = (c == 0) ? chunkBounds[a + 3] : MAX(this->m_cellMax[a], chunkBounds[c * 6 + a + 3]);
+			}
+		}
+
+		// Per-chunk histograms and a prefix scan, ranks taken in index order.
+		uint32_t keyBits = 0;
+		while ((size_t(1) << keyBits) < tableSize) ++keyBits;
+		RadixSortPairs(this->m_bucketOf.data(), this->m_order.data(), count, keyBits, threadCount);
+
+		// Slot s starts every bucket after the previous slot's, up to its own.
+		ParallelFor(count, minChunk, [&](size_t begin, size_t end, size_t){
+			for (size_t i = begin; i < end; ++i){
+				const uint32_t slot = static_cast<uint32_t>(i);
+				const size_t first = (i == 0) ? 0 : size_t(this->m_bucketOf[i - 1]) + 1;
+				for (size_t b = first; b <= this->m_bucketOf[i]; ++b) this->m_cellStart[b] = slot;
+
+				const uint32_t index = this->m_order[i];
+				this->m_index[i] = index;
+				this->m_x[i]	 = points.X(index);
+				this->m_y[i]	 = points.Y(index);
+				this->m_z[i]	 = points.Z(index);
+			}
+		}, threadCount);
+
+		const size_t tail = (count == 0) ? 0 : size_t(this->m_bucketOf[count - 1]) + 1;
+		for (size_t b = tail; b <= tableSize; ++b) this->m_cellStart[b] = static_cast<uint32_t>(count);
+	}
+
+	inline size_t SpatialHash::RadiusInto(const Vector3& center, float radius,
+										  std::vector<uint32_t>& out,
+										  std::vector<uint32_t>& bucketScratch) const {
+		if (this->m_count == 0) return 0;
+
+		const float cx = getXComponent(center);
+		const float cy = getYComponent(center);
+		const float cz = getZComponent(center);
+		const float radiusSq = SQR(radius);
+
+		// The query box clipped to the occupied cells, which all points lie in.
+		int32_t x0, x1, y0, y1, z0, z1;
+		if (!this->CellRange(cx - radius, cx + radius, 0, x0, x1) ||
+			!this->CellRange(cy - radius, cy + radius, 1, y0, y1) ||
+			!this->CellRange(cz - radius, cz + radius, 2, z0, z1)) return 0;
+
+		const size_t before = out.size();
+		auto scanSlots = [&](uint32_t begin, uint32_t end){
+			for (uint32_t s = begin; s < end; ++s){
+				const float distSq = SQR(this->m_x[s] - cx) + SQR(this->m_y[s] - cy) + SQR(this->m_z[s] - cz);
+				if (distSq <= radiusSq) out.push_back(this->m_index[s]);
+			}
+		};
+
+		// More cells than buckets: every bucket is hit anyway, so scan them all.
+		const double cells = (double(x1) - x0 + 1.0) * (double(y1) - y0 + 1.0) * (double(z1) - z0 + 1.0);
+		if (cells > static_cast<double>(this->m_tableMask + 1)){
+			scanSlots(0, static_cast<uint32_t>(this->m_count));
+			return out.size() - before;
+		}
+
+		// Distinct cells can share a bucket; visit each bucket once.
+		bucketScratch.clear();
+		for (int32_t iz = z0; iz <= z1; ++iz)
+			for (int32_t iy = y0; iy <= y1; ++iy)
+				for (int32_t ix = x0; ix <= x1; ++ix)
+					bucketScratch.push_back(this->Bucket(ix, iy, iz));
+
+		std::sort(bucketScratch.begin(), bucketScratch.end());
+		bucketScratch.erase(std::unique(bucketScratch.begin(), bucketScratch.end()), bucketScratch.end());
+
+		for (uint32_t b : bucketScratch) scanSlots(this->m_cellStart[b], this->m_cellStart[b + 1]);
+		return out.size() - before;
+	}
+
+	inline size_t SpatialHash::QueryRadius(const Vector3& center, float radius, std::vector<uint32_t>& out) const {
+		std::vector<uint32_t> bucketScratch;
+		return this->RadiusInto(center, radius, out, bucketScratch);
+	}
+
+	///	Results are in CSR form: query q owns indices[offsets[q] .. offsets[q + 1]).
+	inline void SpatialHash::QueryRadiusBatch(ConstVec3ArrayView centers, float radius,
+											  std::vector<uint32_t>& offsets, std::vector<uint32_t>& indices,
+											  size_t threadCount) const {
+		FGML_SCOPED_TIMER(SpatialHashRadiusBatch);
+		const size_t count = centers.size();
+
+		const size_t minChunk = 256;
+		const size_t chunks = ChunkCount(count, minChunk, threadCount);
+		std::vector<std::vector<uint32_t>> chunkIndices(chunks);
+
+		offsets.resize(count + 1);
+
+		ParallelFor(count, minChunk, [&](size_t begin, size_t end, size_t c){
+			std::vector<uint32_t> bucketScratch;
+			std::vector<uint32_t>& local = chunkIndices[c];
+			for (size_t q = begin; q < end; ++q){
+				offsets[q + 1] = static_cast<uint32_t>(this->RadiusInto(centers.Get(q), radius, local, bucketScratch));
+			}
+		}, threadCount);
+
+		offsets[0] = 0;
+		for (size_t q = 0; q < count; ++q) offsets[q + 1] += offsets[q];
+
+		indices.resize(offsets[count]);
+		const size_t step = (chunks > 0) ? (count + chunks - 1) / chunks : 0;
+		ParallelFor(chunks, 1, [&](size_t begin, size_t end, size_t){
+			for (size_t c = begin; c < end; ++c){
+				const size_t first = MIN(count, c * step);
+				std::copy(chunkIndices[c].begin(), chunkIndices[c].end(), indices.begin() + offsets[first]);
+			}
+		}, threadCount);
+	}
+
+	///	heap, visitedBits and visitedBuckets are per-caller scratch so batch
+	///	chunks reuse them; visitedBits is left all clear on return.
+	inline size_t SpatialHash::KNearestInto(const Vector3& center, size_t k, float maxRadius,
+											uint32_t* outIndices, float* outDistSq,
+											std::vector<std::pair<float, uint32_t>>& heap,
+											std::vector<uint64_t>& visitedBits,
+											std::vector<uint32_t>& visitedBuckets) const {
+		if (this->m_count == 0 || k == 0) return 0;
+
+		const float cx = getXComponent(center);
+		const float cy = getYComponent(center);
+		const float cz = getZComponent(center);
+		const float maxRadiusSq = SQR(maxRadius);
+
+		const int32_t origin[3] = { this->CellCoord(cx), this->CellCoord(cy), this->CellCoord(cz) };
+
+		// Cell offsets that hold points, and the ring that covers all of them.
+		int64_t lo[3], hi[3];
+		int64_t coverRing = 0;
+		for (size_t a = 0; a < 3; ++a){
+			lo[a] = static_cast<int64_t>(this->m_cellMin[a]) - origin[a];
+			hi[a] = static_cast<int64_t>(this->m_cellMax[a]) - origin[a];
+			coverRing = MAX(coverRing, MAX(-lo[a], hi[a]));
+		}
+
+		// Clamp in float before converting: an infinite maxRadius asks for unbounded k-NN.
+		const float radiusRings = std::ceil(maxRadius * this->m_invCellSize);
+		const int64_t maxRing = (radiusRings < static_cast<float>(coverRing)) ? static_cast<int64_t>(radiusRings) : coverRing;
+
+		// Max-heap of (distSq, index); the root is the current worst neighbour.
+		heap.clear();
+		heap.reserve(k);
+		visitedBuckets.clear();
+		const size_t words = (this->m_tableMask >> 6) + 1;
+		if (visitedBits.size() < words) visitedBits.resize(words, 0);
+
+		auto visitCell = [&](int64_t dx, int64_t dy, int64_t dz){
+			const uint32_t b = this->Bucket( static_cast<int32_t>(origin[0] + dx),
+											 static_cast<int32_t>(origin[1] + dy),
+											 static_cast<int32_t>(origin[2] + dz) );
+
+			// Distinct cells can share a bucket; scan each bucket once.
+			uint64_t& word = visitedBits[b >> 6];
+			const uint64_t bit = uint64_t(1) << (b & 63);
+			if (word & bit) return;
+			word |= bit;
+			visitedBuckets.push_back(b);
+
+			const uint32_t end = this->m_cellStart[b + 1];
+			for (uint32_t s = this->m_cellStart[b]; s < end; ++s){
+				const float distSq = SQR(this->m_x[s] - cx) + SQR(this->m_y[s] - cy) + SQR(this->m_z[s] - cz);
+				if (distSq > maxRadiusSq) continue;
+				if (heap.size() == k && distSq >= heap.front().first) continue;
+
+				if (heap.size() == k){
+					std::pop_heap(heap.begin(), heap.end());
+					heap.pop_back();
+				}
+				heap.push_back(std::make_pair(distSq, this->m_index[s]));
+				std::push_heap(heap.begin(), heap.end());
+			}
+		};
+
+		// Rings are clipped to the point bounds, where all non-empty cells lie.
+		for (int64_t ring = 0; ring <= maxRing; ++ring){
+			const int64_t z0 = MAX(-ring, lo[2]), z1 = MIN(ring, hi[2]);
+			const int64_t y0 = MAX(-ring, lo[1]), y1 = MIN(ring, hi[1]);
+			const int64_t x0 = MAX(-ring, lo[0]), x1 = MIN(ring, hi[0]);
+			for (int64_t dz = z0; dz <= z1; ++dz){
+				for (int64_t dy = y0; dy <= y1; ++dy){
+					if (dz == -ring || dz == ring || dy == -ring || dy == ring){
+						for (int64_t dx = x0; dx <= x1; ++dx) visitCell(dx, dy, dz);
+					}
+					else {
+						if (-ring >= lo[0]) visitCell(-ring, dy, dz);
+						if (ring <= hi[0])	visitCell(ring, dy, dz);
+					}
+				}
+			}
+
+			// Cells in ring + 1 are at least ring * cellSize away from the query.
+			if (heap.size() == k && heap.front().first <= SQR(static_cast<float>(ring) * this->m_cellSize)) break;
+		}
+
+		for (uint32_t b : visitedBuckets) visitedBits[b >> 6] &= ~(uint64_t(1) << (b & 63));
+
+		std::sort_heap(heap.begin(), heap.end());
+		for (size_t i = 0; i < heap.size(); ++i){
+			outDistSq[i]  = heap[i].first;
+			outIndices[i] = heap[i].second;
+		}
+		return heap.size();
+	}
+
+	///	Writes up to k neighbours within maxRadius, nearest first; returns how many were found.
+	///	maxRadius may be infinite.
+	inline size_t SpatialHash::QueryKNearest(const Vector3& center, size_t k, float maxRadius,
+											 uint32_t* outIndices, float* outDistSq) const {
+		std::vector<std::pair<float, uint32_t>> heap;
+		std::vector<uint64_t> visitedBits;
+		std::vector<uint32_t> visitedBuckets;
+		return this->KNearestInto(center, k, maxRadius, outIndices, outDistSq, heap, visitedBits, visitedBuckets);
+	}
+
+	///	Each query owns k output slots; unused slots get UINT32_MAX and +infinity.
+	inline void SpatialHash::QueryKNearestBatch(ConstVec3ArrayView centers, size_t k, float maxRadius,
+												uint32_t* outIndices, float* outDistSq,
+												size_t threadCount) const {
+		FGML_SCOPED_TIMER(SpatialHashKNearestBatch);
+
+		ParallelFor(centers.size(), 256, [&](size_t begin, size_t end, size_t){
+			std::vector<std::pair<float, uint32_t>> heap;
+			std::vector<uint64_t> visitedBits;
+			std::vector<uint32_t> visitedBuckets;
+			for (size_t q = begin; q < end; ++q){
+				uint32_t* idx = outIndices + q * k;
+				float*	  dst = outDistSq  + q * k;
+				const size_t found = this->KNearestInto(centers.Get(q), k, maxRadius, idx, dst, heap, visitedBits, visitedBuckets);
+				for (size_t i = found; i < k; ++i){
+					idx[i] = std::numeric_limits<uint32_t>::max();
+					dst[i] = std::numeric_limits<float>::infinity();
+				}
+			}
+		}, threadCount);
+	}
+
+	inline void SpatialHash::Build(const Vector3* points, size_t count, size_t threadCount){
+		this->Build(ConstVec3ArrayView(points, count), threadCount);
+	}
+
+	inline void SpatialHash::QueryRadiusBatch(const Vector3* centers, size_t count, float radius,
+											  std::vector<uint32_t>& offsets, std::vector<uint32_t>& indices,
+											  size_t threadCount) const {
+		this->QueryRadiusBatch(ConstVec3ArrayView(centers, count), radius, offsets, indices, threadCount);
+	}
+
+	inline void SpatialHash::QueryKNearestBatch(const Vector3* centers, size_t count, size_t k, float maxRadius,
+												uint32_t* outIndices, float* outDistSq,
+												size_t threadCount) const {
+		this->QueryKNearestBatch(ConstVec3ArrayView(centers, count), k, maxRadius, outIndices, outDistSq, threadCount);
+	}
+
+	inline size_t SpatialHash::Size(void) const {
+		return this->m_count;
+	}
+
+	inline float SpatialHash::CellSize(void) const {
+		return this->m_cellSize;
+	}
+	///
+	///	Declaration of SpatialHash methods end
+	///
+};
+
+#endif // FGML_SPATIALHASH_HPP_
\ No newline at end of file
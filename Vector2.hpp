@@ -2,6 +2,7 @@
 #include <cmath>
 #include <cassert>
 #include "Macros.hpp"
+#include "Instrument.hpp"
 
 #ifndef FGML_VECTOR2_HPP_
 #define FGML_VECTOR2_HPP_
@@ -36,6 +37,9 @@ namespace FGML {
 
 		inline float&  operator[](const size_t& shifting);
 
+		inline float*		data(void);
+		inline const float* data(void) const;
+
 		friend inline float   DotProduct(const Vector2& vec1, const Vector2& vec2);
 
 		friend inline Vector2 Project(const Vector2& vec1, const Vector2& vec2);
@@ -92,6 +96,9 @@ namespace FGML {
 		return *((&this->m_x) + shifting);
 	}
 
+	inline float*		Vector2::data(void)		 { return &this->m_x; }
+	inline const float* Vector2::data(void) const { return &this->m_x; }
+
 	inline Vector2 operator+(const Vector2& vec1, const Vector2& vec2){
 		return Vector2(vec1.m_x + vec2.m_x, vec1.m_y + vec2.m_y);
 	}
@@ -115,6 +122,7 @@ namespace FGML {
 	};
 
 	inline float   DotProduct(const Vector2& vec1, const Vector2& vec2){
+		FGML_PROBE(Vec2DotProduct);
 		return (vec1.m_x * vec2.m_x + vec1.m_y * vec2.m_y);
 	}
 
@@ -127,10 +135,12 @@ namespace FGML {
 	}
 
 	inline float   Magnitude(const Vector2& vec){	
+		FGML_PROBE(Vec2Magnitude);
 		return sqrt(SQR(vec.m_x) + SQR(vec.m_y));
 	}
 
 	inline Vector2 Normalize(const Vector2& vec){
+		FGML_PROBE(Vec2Normalize);
 		return (vec / Magnitude(vec));
 	}
 
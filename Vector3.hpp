@@ -1,5 +1,6 @@
 #ifndef FGML_VECTOR3_HPP_
 #include "Macros.hpp"
+#include "Instrument.hpp"
 #include <cassert>
 #include <iostream> // debug
 #include <cmath>
@@ -39,6 +40,9 @@ namespace FGML {
 
 		inline float&  operator[](const size_t& shifting);
 
+		inline float*		data(void);
+		inline const float* data(void) const;
+
 		friend inline Vector3 CrossProduct(const Vector3& vec1, const Vector3& vec2);
 		friend inline float	    DotProduct(const Vector3& vec1, const Vector3& vec2);
 
@@ -105,13 +109,18 @@ namespace FGML {
 		return *((&this->m_x) + shifting);
 	}
 
+	inline float*		Vector3::data(void)		 { return &this->m_x; }
+	inline const float* Vector3::data(void) const { return &this->m_x; }
+
 	inline Vector3 CrossProduct(const Vector3& vec1, const Vector3& vec2){
+		FGML_PROBE(Vec3CrossProduct);
 		return Vector3(   (vec1.m_y * vec2.m_z - vec1.m_z * vec2.m_y),
 						 -(vec1.m_x * vec2.m_z - vec1.m_z * vec2.m_x),	
 						  (vec1.m_x * vec2.m_y - vec1.m_y * vec2.m_x)  );
 	}
 
 	inline float   DotProduct(const Vector3& vec1, const Vector3& vec2){
+		FGML_PROBE(Vec3DotProduct);
 		return (vec1.m_x * vec2.m_x + vec1.m_y * vec2.m_y + vec1.m_z * vec2.m_z);
 	}
 
@@ -145,10 +154,12 @@ namespace FGML {
 	}
 
 	inline float   Magnitude(const Vector3& vec){
+		FGML_PROBE(Vec3Magnitude);
 		return sqrt(SQR(vec.m_x) + SQR(vec.m_y) + SQR(vec.m_z));
 	}
 
 	inline Vector3 Normalize(const Vector3& vec){
+		FGML_PROBE(Vec3Normalize);
 		return (vec / Magnitude(vec));
 	}
 
@@ -1,4 +1,5 @@
 #include "Macros.hpp"
+#include "Instrument.hpp"
 #include <cassert>
 #include <iostream> // debug
 #include <cmath>
@@ -42,6 +43,9 @@ namespace FGML {
 
 		inline float&  operator[](const size_t& shifting);
 
+		inline float*		data(void);
+		inline const float* data(void) const;
+
 		friend inline float	  DotProduct(const Vector4& vec1, const Vector4& vec2);
 
 		friend inline Vector4 Project(const Vector4& vec1, const Vector4& vec2);
@@ -149,7 +153,11 @@ namespace FGML {
 		return *((&this->m_x) + shifting);
 	}
 
+	inline float*		Vector4::data(void)		 { return &this->m_x; }
+	inline const float* Vector4::data(void) const { return &this->m_x; }
+
 	inline float    DotProduct(const Vector4& vec1, const Vector4& vec2){
+		FGML_PROBE(Vec4DotProduct);
 		return (vec1.m_x * vec2.m_x + vec1.m_y * vec2.m_y + vec1.m_z * vec2.m_z + vec1.m_w * vec2.m_w);
 	}
 
@@ -162,10 +170,12 @@ namespace FGML {
 	}
 
 	inline float	Magnitude(const Vector4& vec){
+		FGML_PROBE(Vec4Magnitude);
 		return sqrt(SQR(vec.m_x) + SQR(vec.m_y) + SQR(vec.m_z) + SQR(vec.m_w));
 	}
 
 	inline Vector4  Normalize(const Vector4& vec){
+		FGML_PROBE(Vec4Normalize);
 		return (vec / Magnitude(vec));
 	}
 
@@ -0,0 +1,461 @@
+#ifndef FGML_VIEWS_HPP_
+#define FGML_VIEWS_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#include "Vector2.hpp"
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix3x3.hpp"
+#include "Matrix4x4.hpp"
+
+namespace FGML {
+	///	Views reinterpret FGML values as packed floats, so the layouts are pinned.
+	static_assert(sizeof(Vector2) == 2 * sizeof(float), "Vector2 must be 2 packed floats");
+	static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 must be 3 packed floats");
+	static_assert(sizeof(Vector4) == 4 * sizeof(float), "Vector4 must be 4 packed floats");
+	static_assert(sizeof(Matrix3x3) == 9 * sizeof(float), "Matrix3x3 must be 9 packed floats");
+	static_assert(sizeof(Matrix4x4) == 16 * sizeof(float), "Matrix4x4 must be 16 packed floats");
+
+	///
+	///	Definition of BasicVecView class
+	///
+	///	Non-owning view of size floats spaced stride floats apart, such as a
+	///	matrix row, a matrix column or one attribute of an interleaved
+	///	buffer. T is float (VecView) or const float (ConstVecView). Views
+	///	are cheap to copy and never outlive the memory they wrap.
+	///
+	template<typename T>
+	class BasicVecView {
+		static_assert(std::is_same<typename std::remove_const<T>::type, float>::value, "Views wrap float storage");
+	private:
+		T*	   m_data;
+		size_t m_size;
+		size_t m_stride;
+	public:
+		BasicVecView(T* data, size_t size, size_t stride = 1);
+
+		template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		BasicVecView(const BasicVecView<U>& other);
+
+		inline T&	  operator[](size_t i) const;
+
+		inline T*	  data(void) const;
+		inline size_t size(void) const;
+		inline size_t Stride(void) const;
+
+		~BasicVecView() = default;
+	};
+
+	using VecView	   = BasicVecView<float>;
+	using ConstVecView = BasicVecView<const float>;
+	///
+	///	Definition of BasicVecView class end
+	///
+
+	///
+	///	Definition of BasicMatView class
+	///
+	///	Non-owning rows x columns view. RowMajor stores each row contiguously
+	///	with leadingStride floats between rows; ColumnMajor is the transpose
+	///	(the usual GPU upload layout). A leadingStride of 0 means packed.
+	///
+	enum class MatrixLayout {
+		RowMajor,
+		ColumnMajor
+	};
+
+	template<typename T>
+	class BasicMatView {
+		static_assert(std::is_same<typename std::remove_const<T>::type, float>::value, "Views wrap float storage");
+	private:
+		T*			 m_data;
+		size_t		 m_rows;
+		size_t		 m_columns;
+		size_t		 m_leading;
+		MatrixLayout m_layout;
+	public:
+		BasicMatView(T* data, size_t rows, size_t columns,
+					 MatrixLayout layout = MatrixLayout::RowMajor, size_t leadingStride = 0);
+
+		template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		BasicMatView(const BasicMatView<U>& other);
+
+		inline T&			   operator()(size_t row, size_t column) const;
+
+		inline BasicVecView<T> Row(size_t row) const;
+		inline BasicVecView<T> Column(size_t column) const;
+
+		inline T*			   data(void) const;
+		inline size_t		   Rows(void) const;
+		inline size_t		   Columns(void) const;
+		inline size_t		   LeadingStride(void) const;
+		inline MatrixLayout	   Layout(void) const;
+
+		~BasicMatView() = default;
+	};
+
+	using MatView	   = BasicMatView<float>;
+	using ConstMatView = BasicMatView<const float>;
+	///
+	///	Definition of BasicMatView class end
+	///
+
+	///
+	///	Definition of BasicVec3ArrayView class
+	///
+	///	count Vector3 values stored stride floats apart, e.g. the position
+	///	stream of an interleaved vertex buffer. Wraps Vector3 arrays too.
+	///
+	template<typename T>
+	class BasicVec3ArrayView {
+		static_assert(std::is_same<typename std::remove_const<T>::type, float>::value, "Views wrap float storage");
+	public:
+		using VectorType = typename std::conditional<std::is_const<T>::value, const Vector3, Vector3>::type;
+	private:
+		T*	   m_data;
+		size_t m_count;
+		size_t m_stride;
+	public:
+		BasicVec3ArrayView(T* data, size_t count, size_t stride = 3);
+		BasicVec3ArrayView(VectorType* vectors, size_t count);
+
+		template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		BasicVec3ArrayView(const BasicVec3ArrayView<U>& other);
+
+		inline T&				   X(size_t i) const;
+		inline T&				   Y(size_t i) const;
+		inline T&				   Z(size_t i) const;
+
+		inline BasicVecView<T>	   operator[](size_t i) const;
+		inline Vector3			   Get(size_t i) const;
+		inline void				   Set(size_t i, const Vector3& value) const;
+
+		inline BasicVec3ArrayView  Subview(size_t first, size_t count) const;
+
+		inline T*				   data(void) const;
+		inline size_t			   size(void) const;
+		inline size_t			   Stride(void) const;
+
+		~BasicVec3ArrayView() = default;
+	};
+
+	using Vec3ArrayView		 = BasicVec3ArrayView<float>;
+	using ConstVec3ArrayView = BasicVec3ArrayView<const float>;
+	///
+	///	Definition of BasicVec3ArrayView class end
+	///
+
+	///
+	///	Definition of BasicMat4ArrayView class
+	///
+	///	count packed 4x4 matrices stored stride floats apart in either
+	///	layout, e.g. a column-major instance buffer. Wraps Matrix4x4 arrays
+	///	too (row-major, stride 16).
+	///
+	template<typename T>
+	class BasicMat4ArrayView {
+		static_assert(std::is_same<typename std::remove_const<T>::type, float>::value, "Views wrap float storage");
+	public:
+		using MatrixType = typename std::conditional<std::is_const<T>::value, const Matrix4x4, Matrix4x4>::type;
+	private:
+		T*			 m_data;
+		size_t		 m_count;
+		size_t		 m_stride;
+		MatrixLayout m_layout;
+	public:
+		BasicMat4ArrayView(T* data, size_t count, MatrixLayout layout = MatrixLayout::RowMajor, size_t stride = 16);
+		BasicMat4ArrayView(MatrixType* mats, size_t count);
+
+		template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		BasicMat4ArrayView(const BasicMat4ArrayView<U>& other);
+
+		inline T&				  At(size_t i, size_t row, size_t column) const;
+
+		inline BasicMatView<T>	  operator[](size_t i) const;
+		inline Matrix4x4		  Get(size_t i) const;
+		inline void				  Set(size_t i, const Matrix4x4& value) const;
+
+		inline BasicMat4ArrayView Subview(size_t first, size_t count) const;
+
+		inline T*				  data(void) const;
+		inline size_t			  size(void) const;
+		inline size_t			  Stride(void) const;
+		inline MatrixLayout		  Layout(void) const;
+
+		~BasicMat4ArrayView() = default;
+	};
+
+	using Mat4ArrayView		 = BasicMat4ArrayView<float>;
+	using ConstMat4ArrayView = BasicMat4ArrayView<const float>;
+	///
+	///	Definition of BasicMat4ArrayView class end
+	///
+
+	///
+	///	Declaration of BasicVecView methods
+	///
+	template<typename T>
+	inline BasicVecView<T>::BasicVecView(T* data, size_t size, size_t stride)
+	: m_data(data), m_size(size), m_stride(stride) {}
+
+	template<typename T>
+	template<typename U, typename>
+	inline BasicVecView<T>::BasicVecView(const BasicVecView<U>& other)
+	: m_data(other.data()), m_size(other.size()), m_stride(other.Stride()) {}
+
+	template<typename T>
+	inline T& BasicVecView<T>::operator[](size_t i) const {
+		assert(i < this->m_size && "Going beyond the view!");
+		return this->m_data[i * this->m_stride];
+	}
+
+	template<typename T>
+	inline T*	  BasicVecView<T>::data(void) const	  { return this->m_data; }
+	template<typename T>
+	inline size_t BasicVecView<T>::size(void) const	  { return this->m_size; }
+	template<typename T>
+	inline size_t BasicVecView<T>::Stride(void) const { return this->m_stride; }
+	///
+	///	Declaration of BasicVecView methods end
+	///
+
+	///
+	///	Declaration of BasicMatView methods
+	///
+	template<typename T>
+	inline BasicMatView<T>::BasicMatView(T* data, size_t rows, size_t columns, MatrixLayout layout, size_t leadingStride)
+	: m_data(data), m_rows(rows), m_columns(columns),
+	  m_leading(leadingStride != 0 ? leadingStride : (layout == MatrixLayout::RowMajor ? columns : rows)),
+	  m_layout(layout) {}
+
+	template<typename T>
+	template<typename U, typename>
+	inline BasicMatView<T>::BasicMatView(const BasicMatView<U>& other)
+	: m_data(other.data()), m_rows(other.Rows()), m_columns(other.Columns()),
+	  m_leading(other.LeadingStride()), m_layout(other.Layout()) {}
+
+	template<typename T>
+	inline T& BasicMatView<T>::operator()(size_t row, size_t column) const {
+		assert(row < this->m_rows && column < this->m_columns && "Going beyond the matrix!");
+		return (this->m_layout == MatrixLayout::RowMajor) ? this->m_data[row * this->m_leading + column]
+														  : this->m_data[column * this->m_leading + row];
+	}
+
+	template<typename T>
+	inline BasicVecView<T> BasicMatView<T>::Row(size_t row) const {
+		assert(row < this->m_rows && "Going beyond the matrix!");
+		return (this->m_layout == MatrixLayout::RowMajor)
+			 ? BasicVecView<T>(this->m_data + row * this->m_leading, this->m_columns, 1)
+			 : BasicVecView<T>(this->m_data + row, this->m_columns, this->m_leading);
+	}
+
+	template<typename T>
+	inline BasicVecView<T> BasicMatView<T>::Column(size_t column) const {
+		assert(column < this->m_columns && "Going beyond the matrix!");
+		return (this->m_layout == MatrixLayout::RowMajor)
+			 ? BasicVecView<T>(this->m_data + column, this->m_rows, this->m_leading)
+			 : BasicVecView<T>(this->m_data + column * this->m_leading, this->m_rows, 1);
+	}
+
+	template<typename T>
+	inline T*			BasicMatView<T>::data(void) const		   { return this->m_data; }
+	template<typename T>
+	inline size_t		BasicMatView<T>::Rows(void) const		   { return this->m_rows; }
+	template<typename T>
+	inline size_t		BasicMatView<T>::Columns(void) const	   { return this->m_columns; }
+	template<typename T>
+	inline size_t		BasicMatView<T>::LeadingStride(void) const { return this->m_leading; }
+	template<typename T>
+	inline MatrixLayout BasicMatView<T>::Layout(void) const		   { return this->m_layout; }
+	///
+	///	Declaration of BasicMatView methods end
+	///
+
+	///
+	///	Declaration of BasicVec3ArrayView methods
+	///
+	template<typename T>
+	inline BasicVec3ArrayView<T>::BasicVec3ArrayView(T* data, size_t count, size_t stride)
+	: m_data(data), m_count(count), m_stride(stride) {
+		assert(stride >= 3 && "Elements overlap!");
+	}
+
+	template<typename T>
+	inline BasicVec3ArrayView<T>::BasicVec3ArrayView(VectorType* vectors, size_t count)
+	: m_data(count != 0 ? vectors->data() : nullptr), m_count(count), m_stride(3) {}
+
+	template<typename T>
+	template<typename U, typename>
+	inline BasicVec3ArrayView<T>::BasicVec3ArrayView(const BasicVec3ArrayView<U>& other)
+	: m_data(other.data()), m_count(other.size()), m_stride(other.Stride()) {}
+
+	template<typename T>
+	inline T& BasicVec3ArrayView<T>::X(size_t i) const { return this->m_data[i * this->m_stride]; }
+	template<typename T>
+	inline T& BasicVec3ArrayView<T>::Y(size_t i) const { return this->m_data[i * this->m_stride + 1]; }
+	template<typename T>
+	inline T& BasicVec3ArrayView<T>::Z(size_t i) const { return this->m_data[i * this->m_stride + 2]; }
+
+	template<typename T>
+	inline BasicVecView<T> BasicVec3ArrayView<T>::operator[](size_t i) const {
+		assert(i < this->m_count && "Going beyond the view!");
+		return BasicVecView<T>(this->m_data + i * this->m_stride, 3, 1);
+	}
+
+	template<typename T>
+	inline Vector3 BasicVec3ArrayView<T>::Get(size_t i) const {
+		assert(i < this->m_count && "Going beyond the view!");
+		return Vector3(this->X(i), this->Y(i), this->Z(i));
+	}
+
+	template<typename T>
+	inline void BasicVec3ArrayView<T>::Set(size_t i, const Vector3& value) const {
+		assert(i < this->m_count && "Going beyond the view!");
+		this->X(i) = getXComponent(value);
+		this->Y(i) = getYComponent(value);
+		this->Z(i) = getZComponent(value);
+	}
+
+	template<typename T>
+	inline BasicVec3ArrayView<T> BasicVec3ArrayView<T>::Subview(size_t first, size_t count) const {
+		assert(first + count <= this->m_count && "Going beyond the view!");
+		return BasicVec3ArrayView<T>(this->m_data + first * this->m_stride, count, this->m_stride);
+	}
+
+	template<typename T>
+	inline T*	  BasicVec3ArrayView<T>::data(void) const	{ return this->m_data; }
+	template<typename T>
+	inline size_t BasicVec3ArrayView<T>::size(void) const	{ return this->m_count; }
+	template<typename T>
+	inline size_t BasicVec3ArrayView<T>::Stride(void) const { return this->m_stride; }
+	///
+	///	Declaration of BasicVec3ArrayView methods end
+	///
+
+	///
+	///	Declaration of BasicMat4ArrayView methods
+	///
+	template<typename T>
+	inline BasicMat4ArrayView<T>::BasicMat4ArrayView(T* data, size_t count, MatrixLayout layout, size_t stride)
+	: m_data(data), m_count(count), m_stride(stride), m_layout(layout) {
+		assert(stride >= 16 && "Elements overlap!");
+	}
+
+	template<typename T>
+	inline BasicMat4ArrayView<T>::BasicMat4ArrayView(MatrixType* mats, size_t count)
+	: m_data(count != 0 ? mats->data() : nullptr), m_count(count), m_stride(16), m_layout(MatrixLayout::RowMajor) {}
+
+	template<typename T>
+	template<typename U, typename>
+	inline BasicMat4ArrayView<T>::BasicMat4ArrayView(const BasicMat4ArrayView<U>& other)
+	: m_data(other.data()), m_count(other.size()), m_stride(other.Stride()), m_layout(other.Layout()) {}
+
+	template<typename T>
+	inline T& BasicMat4ArrayView<T>::At(size_t i, size_t row, size_t column) const {
+		assert(i < this->m_count && row < 4uL && column < 4uL && "Going beyond the view!");
+		T* base = this->m_data + i * this->m_stride;
+		return (this->m_layout == MatrixLayout::RowMajor) ? base[row * 4 + column] : base[column * 4 + row];
+	}
+
+	template<typename T>
+	inline BasicMatView<T> BasicMat4ArrayView<T>::operator[](size_t i) const {
+		assert(i < this->m_count && "Going beyond the view!");
+		return BasicMatView<T>(this->m_data + i * this->m_stride, 4, 4, this->m_layout);
+	}
+
+	template<typename T>
+	inline Matrix4x4 BasicMat4ArrayView<T>::Get(size_t i) const {
+		return Matrix4x4( this->At(i, 0, 0), this->At(i, 0, 1), this->At(i, 0, 2), this->At(i, 0, 3),
+						  this->At(i, 1, 0), this->At(i, 1, 1), this->At(i, 1, 2), this->At(i, 1, 3),
+						  this->At(i, 2, 0), this->At(i, 2, 1), this->At(i, 2, 2), this->At(i, 2, 3),
+						  this->At(i, 3, 0), this->At(i, 3, 1), this->At(i, 3, 2), this->At(i, 3, 3) );
+	}
+
+	template<typename T>
+	inline void BasicMat4ArrayView<T>::Set(size_t i, const Matrix4x4& value) const {
+		for (size_t row = 0; row < 4; ++row)
+			for (size_t column = 0; column < 4; ++column) this->At(i, row, column) = getElement(value, row, column);
+	}
+
+	template<typename T>
+	inline BasicMat4ArrayView<T> BasicMat4ArrayView<T>::Subview(size_t first, size_t count) const {
+		assert(first + count <= this->m_count && "Going beyond the view!");
+		return BasicMat4ArrayView<T>(this->m_data + first * this->m_stride, count, this->m_layout, this->m_stride);
+	}
+
+	template<typename T>
+	inline T*			BasicMat4ArrayView<T>::data(void) const	  { return this->m_data; }
+	template<typename T>
+	inline size_t		BasicMat4ArrayView<T>::size(void) const	  { return this->m_count; }
+	template<typename T>
+	inline size_t		BasicMat4ArrayView<T>::Stride(void) const { return this->m_stride; }
+	template<typename T>
+	inline MatrixLayout BasicMat4ArrayView<T>::Layout(void) const { return this->m_layout; }
+	///
+	///	Declaration of BasicMat4ArrayView methods end
+	///
+
+	///
+	///	Views of FGML values
+	///
+	///	Mutable views write straight into the value's storage.
+	inline VecView		View(Vector2& vec)		 { return VecView(vec.data(), 2); }
+	inline ConstVecView View(const Vector2& vec) { return ConstVecView(vec.data(), 2); }
+	inline VecView		View(Vector3& vec)		 { return VecView(vec.data(), 3); }
+	inline ConstVecView View(const Vector3& vec) { return ConstVecView(vec.data(), 3); }
+	inline VecView		View(Vector4& vec)		 { return VecView(vec.data(), 4); }
+	inline ConstVecView View(const Vector4& vec) { return ConstVecView(vec.data(), 4); }
+
+	inline MatView		View(Matrix3x3& mat)	   { return MatView(mat.data(), 3, 3); }
+	inline ConstMatView View(const Matrix3x3& mat) { return ConstMatView(mat.data(), 3, 3); }
+	inline MatView		View(Matrix4x4& mat)	   { return MatView(mat.data(), 4, 4); }
+	inline ConstMatView View(const Matrix4x4& mat) { return ConstMatView(mat.data(), 4, 4); }
+
+	///	Row and column references; unlike operator[] these do not copy.
+	inline VecView		RowView(Matrix3x3& mat, size_t row)				  { return View(mat).Row(row); }
+	inline ConstVecView RowView(const Matrix3x3& mat, size_t row)		  { return View(mat).Row(row); }
+	inline VecView		ColumnView(Matrix3x3& mat, size_t column)		  { return View(mat).Column(column); }
+	inline ConstVecView ColumnView(const Matrix3x3& mat, size_t column)	  { return View(mat).Column(column); }
+	inline VecView		RowView(Matrix4x4& mat, size_t row)				  { return View(mat).Row(row); }
+	inline ConstVecView RowView(const Matrix4x4& mat, size_t row)		  { return View(mat).Row(row); }
+	inline VecView		ColumnView(Matrix4x4& mat, size_t column)		  { return View(mat).Column(column); }
+	inline ConstVecView ColumnView(const Matrix4x4& mat, size_t column)	  { return View(mat).Column(column); }
+
+	inline Vector3 ToVector3(const ConstVecView& view){
+		assert(view.size() >= 3 && "View too short!");
+		return Vector3(view[0], view[1], view[2]);
+	}
+
+	inline Vector4 ToVector4(const ConstVecView& view){
+		assert(view.size() >= 4 && "View too short!");
+		return Vector4(view[0], view[1], view[2], view[3]);
+	}
+
+	inline Matrix4x4 ToMatrix4x4(const ConstMatView& view){
+		assert(view.Rows() == 4 && view.Columns() == 4 && "Not a 4x4 view!");
+		return Matrix4x4( view(0, 0), view(0, 1), view(0, 2), view(0, 3),
+						  view(1, 0), view(1, 1), view(1, 2), view(1, 3),
+						  view(2, 0), view(2, 1), view(2, 2), view(2, 3),
+						  view(3, 0), view(3, 1), view(3, 2), view(3, 3) );
+	}
+
+	///	Element-wise copy between views of the same shape.
+	inline void Assign(const VecView& dst, const ConstVecView& src){
+		assert(dst.size() == src.size() && "Size mismatch!");
+		for (size_t i = 0; i < src.size(); ++i) dst[i] = src[i];
+	}
+
+	inline void Assign(const MatView& dst, const ConstMatView& src){
+		assert(dst.Rows() == src.Rows() && dst.Columns() == src.Columns() && "Size mismatch!");
+		for (size_t row = 0; row < src.Rows(); ++row)
+			for (size_t column = 0; column < src.Columns(); ++column) dst(row, column) = src(row, column);
+	}
+	///
+	///	Views of FGML values end
+	///
+};
+
+#endif // FGML_VIEWS_HPP_
\ No newline at end of file
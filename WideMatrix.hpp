@@ -0,0 +1,378 @@
+#ifndef FGML_WIDEMATRIX_HPP_
+#define FGML_WIDEMATRIX_HPP_
+
+#include <cassert>
+#include <cstddef>
+
+#include "Macros.hpp"
+#include "Instrument.hpp"
+#include "Parallel.hpp"
+#include "SIMD.hpp"
+#include "Vector4.hpp"
+#include "Matrix4x4.hpp"
+#include "Views.hpp"
+
+namespace FGML {
+	///
+	///	Definition of Matrix4x4xN class
+	///
+	///	N independent 4x4 matrices stored lane-wise (AoSoA): each of the 16
+	///	elements is a contiguous run of N floats. The free functions below
+	///	operate on all N matrices at once, running whole SimdFloat blocks
+	///	and a scalar tail when N is not a multiple of the register width.
+	///	Pick N as a multiple of SimdFloat::Width (4 for SSE2, 8 for AVX).
+	///
+	template<size_t N>
+	class Matrix4x4xN {
+		static_assert(N > 0, "Matrix4x4xN needs at least one lane");
+	private:
+		alignas(32) float m_lanes[16][N];
+	public:
+		static const size_t Lanes = N;
+
+		Matrix4x4xN() = default;
+
+		inline float*		Element(size_t row, size_t column);
+		inline const float* Element(size_t row, size_t column) const;
+
+		///	Loads the first count matrices of the view into lanes [0, count);
+		///	the rest become identity. Any layout and stride is accepted.
+		inline void Load(ConstMat4ArrayView mats, size_t count);
+		inline void Store(Mat4ArrayView mats, size_t count) const;
+		inline void Load(const Matrix4x4* mats, size_t count = N);
+		inline void Store(Matrix4x4* mats, size_t count = N) const;
+
+		inline Matrix4x4 getLane(size_t lane) const;
+
+		~Matrix4x4xN() = default;
+	};
+	///
+	///	Definition of Matrix4x4xN class end
+	///
+
+	///
+	///	Declaration of Matrix4x4xN methods
+	///
+	template<size_t N>
+	inline float* Matrix4x4xN<N>::Element(size_t row, size_t column){
+		assert(row < 4uL && column < 4uL && "Going beyond the matrix!");
+		return this->m_lanes[row * 4 + column];
+	}
+
+	template<size_t N>
+	inline const float* Matrix4x4xN<N>::Element(size_t row, size_t column) const {
+		assert(row < 4uL && column < 4uL && "Going beyond the matrix!");
+		return this->m_lanes[row * 4 + column];
+	}
+
+	///	Each 4x4 block is read as four packed groups of four floats: rows for
+	///	row-major storage, columns for column-major. Group g, element k of a
+	///	matrix is lane slot g * 4 + k or k * 4 + g respectively.
+	inline size_t WideLaneSlot(MatrixLayout layout, size_t group, size_t k){
+		return (layout == MatrixLayout::RowMajor) ? group * 4 + k : k * 4 + group;
+	}
+
+	template<size_t N>
+	inline void Matrix4x4xN<N>::Load(ConstMat4ArrayView mats, size_t count){
+		assert(count <= N && count <= mats.size() && "More matrices than lanes!");
+		const float*		 src	= mats.data();
+		const size_t		 stride = mats.Stride();
+		const MatrixLayout layout = mats.Layout();
+		size_t l = 0;
+	#if defined(FGML_SIMD_AVX) || defined(FGML_SIMD_SSE)
+		// Four matrices at a time: group g of each is a 4-wide register, and a
+		// 4x4 transpose turns those into slots (g, 0..3) across 4 lanes.
+		for (; l + 4 <= count; l += 4){
+			for (size_t g = 0; g < 4; ++g){
+				__m128 c0 = _mm_loadu_ps(src + (l + 0) * stride + g * 4);
+				__m128 c1 = _mm_loadu_ps(src + (l + 1) * stride + g * 4);
+				__m128 c2 = _mm_loadu_ps(src + (l + 2) * stride + g * 4);
+				__m128 c3 = _mm_loadu_ps(src + (l + 3) * stride + g * 4);
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				_mm_storeu_ps(this->m_lanes[WideLaneSlot(layout, g, 0)] + l, c0);
+				_mm_storeu_ps(this->m_lanes[WideLaneSlot(layout, g, 1)] + l, c1);
+				_mm_storeu_ps(this->m_lanes[WideLaneSlot(layout, g, 2)] + l, c2);
+				_mm_storeu_ps(this->m_lanes[WideLaneSlot(layout, g, 3)] + l, c3);
+			}
+		}
+	#endif
+		for (; l < count; ++l)
+			for (size_t g = 0; g < 4; ++g)
+				for (size_t k = 0; k < 4; ++k) this->m_lanes[WideLaneSlot(layout, g, k)][l] = src[l * stride + g * 4 + k];
+		for (; l < N; ++l)
+			for (size_t k = 0; k < 16; ++k) this->m_lanes[k][l] = (k % 5 == 0) ? 1.0f : 0.0f;
+	}
+
+	template<size_t N>
+	inline void Matrix4x4xN<N>::Store(Mat4ArrayView mats, size_t count) const {
+		assert(count <= N && count <= mats.size() && "More matrices than lanes!");
+		float*			   dst	  = mats.data();
+		const size_t	   stride = mats.Stride();
+		const MatrixLayout layout = mats.Layout();
+		size_t l = 0;
+	#if defined(FGML_SIMD_AVX) || defined(FGML_SIMD_SSE)
+		for (; l + 4 <= count; l += 4){
+			for (size_t g = 0; g < 4; ++g){
+				__m128 c0 = _mm_loadu_ps(this->m_lanes[WideLaneSlot(layout, g, 0)] + l);
+				__m128 c1 = _mm_loadu_ps(this->m_lanes[WideLaneSlot(layout, g, 1)] + l);
+				__m128 c2 = _mm_loadu_ps(this->m_lanes[WideLaneSlot(layout, g, 2)] + l);
+				__m128 c3 = _mm_loadu_ps(this->m_lanes[WideLaneSlot(layout, g, 3)] + l);
+				_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+				_mm_storeu_ps(dst + (l + 0) * stride + g * 4, c0);
+				_mm_storeu_ps(dst + (l + 1) * stride + g * 4, c1);
+				_mm_storeu_ps(dst + (l + 2) * stride + g * 4, c2);
+				_mm_storeu_ps(dst + (l + 3) * stride + g * 4, c3);
+			}
+		}
+	#endif
+		for (; l < count; ++l)
+			for (size_t g = 0; g < 4; ++g)
+				for (size_t k = 0; k < 4; ++k) dst[l * stride + g * 4 + k] = this->m_lanes[WideLaneSlot(layout, g, k)][l];
+	}
+
+	template<size_t N>
+	inline void Matrix4x4xN<N>::Load(const Matrix4x4* mats, size_t count){
+		this->Load(ConstMat4ArrayView(mats, count), count);
+	}
+
+	template<size_t N>
+	inline void Matrix4x4xN<N>::Store(Matrix4x4* mats, size_t count) const {
+		this->Store(Mat4ArrayView(mats, count), count);
+	}
+
+	template<size_t N>
+	inline Matrix4x4 Matrix4x4xN<N>::getLane(size_t l) const {
+		assert(l < N && "Going beyond the lanes!");
+		const float (&e)[16][N] = this->m_lanes;
+		return Matrix4x4( e[0][l],  e[1][l],  e[2][l],  e[3][l],
+						  e[4][l],  e[5][l],  e[6][l],  e[7][l],
+						  e[8][l],  e[9][l],  e[10][l], e[11][l],
+						  e[12][l], e[13][l], e[14][l], e[15][l] );
+	}
+	///
+	///	Declaration of Matrix4x4xN methods end
+	///
+
+	///
+	///	Lane kernels
+	///
+	///	Runs body(zero, lane, load, store) over full SimdFloat blocks of the
+	///	N lanes, then over the scalar tail; the generic body is written once.
+	template<size_t N, typename Body>
+	inline void ForEachWideLane(Body&& body){
+		const auto loadSimd	  = [](const float* src){ return SimdFloat::Load(src); };
+		const auto storeSimd  = [](float* dst, const SimdFloat& value){ value.Store(dst); };
+		const auto loadScalar  = [](const float* src){ return *src; };
+		const auto storeScalar = [](float* dst, float value){ *dst = value; };
+
+		const size_t simdEnd = N - N % SimdFloat::Width;
+		for (size_t l = 0; l < simdEnd; l += SimdFloat::Width) body(SimdFloat::Zero(), l, loadSimd, storeSimd);
+		for (size_t l = simdEnd; l < N; ++l) body(0.0f, l, loadScalar, storeScalar);
+	}
+
+	///	out = a * b per lane. out may alias a or b.
+	template<size_t N>
+	inline void Multiply(const Matrix4x4xN<N>& a, const Matrix4x4xN<N>& b, Matrix4x4xN<N>& out){
+		ForEachWideLane<N>([&](auto zero, size_t l, auto load, auto store){
+			using T = decltype(zero);
+			T rhs[16];
+			for (size_t k = 0; k < 16; ++k) rhs[k] = load(b.Element(k / 4, k % 4) + l);
+
+			for (size_t row = 0; row < 4; ++row){
+				const T a0 = load(a.Element(row, 0) + l), a1 = load(a.Element(row, 1) + l);
+				const T a2 = load(a.Element(row, 2) + l), a3 = load(a.Element(row, 3) + l);
+				for (size_t column = 0; column < 4; ++column){
+					const T value = MulAdd(a0, rhs[column],
+									MulAdd(a1, rhs[4 + column],
+									MulAdd(a2, rhs[8 + column], a3 * rhs[12 + column])));
+					store(out.Element(row, column) + l, value);
+				}
+			}
+		});
+	}
+
+	template<size_t N>
+	inline Matrix4x4xN<N> operator*(const Matrix4x4xN<N>& a, const Matrix4x4xN<N>& b){
+		Matrix4x4xN<N> out;
+		Multiply(a, b, out);
+		return out;
+	}
+
+	///	General inverse by cofactor expansion over 2x2 minors. Singular lanes
+	///	produce non-finite values; pass determinants to screen them.
+	///	out may alias mat.
+	template<size_t N>
+	inline void Inverse(const Matrix4x4xN<N>& mat, Matrix4x4xN<N>& out, float* determinants = nullptr){
+		ForEachWideLane<N>([&](auto zero, size_t l, auto load, auto store){
+			using T = decltype(zero);
+			T a[4][4];
+			for (size_t row = 0; row < 4; ++row)
+				for (size_t column = 0; column < 4; ++column) a[row][column] = load(mat.Element(row, column) + l);
+
+			const T s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+			const T s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+			const T s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+			const T s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+			const T s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+			const T s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+			const T c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+			const T c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+			const T c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+			const T c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+			const T c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+			const T c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+			const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			const T inv = T(1.0f) / det;
+			if (determinants != nullptr) store(determinants + l, det);
+
+			store(out.Element(0, 0) + l, ( a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * inv);
+			store(out.Element(0, 1) + l, (-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * inv);
+			store(out.Element(0, 2) + l, ( a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * inv);
+			store(out.Element(0, 3) + l, (-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * inv);
+
+			store(out.Element(1, 0) + l, (-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * inv);
+			store(out.Element(1, 1) + l, ( a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * inv);
+			store(out.Element(1, 2) + l, (-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * inv);
+			store(out.Element(1, 3) + l, ( a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * inv);
+
+			store(out.Element(2, 0) + l, ( a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * inv);
+			store(out.Element(2, 1) + l, (-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * inv);
+			store(out.Element(2, 2) + l, ( a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * inv);
+			store(out.Element(2, 3) + l, (-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * inv);
+
+			store(out.Element(3, 0) + l, (-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * inv);
+			store(out.Element(3, 1) + l, ( a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * inv);
+			store(out.Element(3, 2) + l, (-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * inv);
+			store(out.Element(3, 3) + l, ( a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * inv);
+		});
+	}
+
+	template<size_t N>
+	inline Matrix4x4xN<N> Inverse(const Matrix4x4xN<N>& mat){
+		Matrix4x4xN<N> out;
+		Inverse(mat, out);
+		return out;
+	}
+
+	///	Transforms one SoA vector per lane: (x, y, z, w)[l] = mat[l] * in[l].
+	///	The outputs may alias the inputs.
+	template<size_t N>
+	inline void TransformVectors(const Matrix4x4xN<N>& mat,
+						  const float* x, const float* y, const float* z, const float* w,
+						  float* outX, float* outY, float* outZ, float* outW){
+		ForEachWideLane<N>([&](auto zero, size_t l, auto load, auto store){
+			using T = decltype(zero);
+			const T vx = load(x + l), vy = load(y + l), vz = load(z + l), vw = load(w + l);
+			float* const outs[4] = { outX, outY, outZ, outW };
+			for (size_t row = 0; row < 4; ++row){
+				const T value = MulAdd(load(mat.Element(row, 0) + l), vx,
+								MulAdd(load(mat.Element(row, 1) + l), vy,
+								MulAdd(load(mat.Element(row, 2) + l), vz, load(mat.Element(row, 3) + l) * vw)));
+				store(outs[row] + l, value);
+			}
+		});
+	}
+
+	///	AoS convenience: out[l] = mat[l] * in[l] for l < count.
+	template<size_t N>
+	inline void TransformVectors(const Matrix4x4xN<N>& mat, const Vector4* in, Vector4* out, size_t count = N){
+		assert(count <= N && "More vectors than lanes!");
+		alignas(32) float v[4][N] = {};
+		for (size_t l = 0; l < count; ++l){
+			v[0][l] = getXComponent(in[l]);
+			v[1][l] = getYComponent(in[l]);
+			v[2][l] = getZComponent(in[l]);
+			v[3][l] = getWComponent(in[l]);
+		}
+		TransformVectors(mat, v[0], v[1], v[2], v[3], v[0], v[1], v[2], v[3]);
+		for (size_t l = 0; l < count; ++l) out[l] = Vector4(v[0][l], v[1][l], v[2][l], v[3][l]);
+	}
+	///
+	///	Lane kernels end
+	///
+
+	///
+	///	Batch entry points
+	///
+	///	Array entry points for callers that hold Matrix4x4 buffers. Each pack
+	///	is transposed in and out, which costs about as much as the math;
+	///	keep transforms in Matrix4x4xN between passes for full throughput.
+	///
+	///	Lanes per pack: two AVX registers.
+	const size_t WIDE_MATRIX_LANES = 16;
+	const size_t WIDE_MATRIX_MIN_CHUNK = 4096;
+
+	using Matrix4x4xWide = Matrix4x4xN<WIDE_MATRIX_LANES>;
+
+	///	Runs pack(first, count) over packs of WIDE_MATRIX_LANES in parallel.
+	template<typename Pack>
+	inline void ForEachWidePack(size_t count, size_t threadCount, Pack&& pack){
+		const size_t packs = (count + WIDE_MATRIX_LANES - 1) / WIDE_MATRIX_LANES;
+		ParallelFor(packs, WIDE_MATRIX_MIN_CHUNK / WIDE_MATRIX_LANES, [&](size_t begin, size_t end, size_t){
+			for (size_t p = begin; p < end; ++p){
+				const size_t first = p * WIDE_MATRIX_LANES;
+				pack(first, MIN(WIDE_MATRIX_LANES, count - first));
+			}
+		}, threadCount);
+	}
+
+	///	out[i] = a[i] * b[i]; out may alias a or b. The views may use any
+	///	layout or stride, so external column-major buffers need no copy.
+	inline void MultiplyBatch(ConstMat4ArrayView a, ConstMat4ArrayView b, Mat4ArrayView out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(WideMultiplyBatch);
+		assert(b.size() >= a.size() && out.size() >= a.size() && "Mismatched batch sizes!");
+		ForEachWidePack(a.size(), threadCount, [&](size_t first, size_t lanes){
+			Matrix4x4xWide wa, wb;
+			wa.Load(a.Subview(first, lanes), lanes);
+			wb.Load(b.Subview(first, lanes), lanes);
+			Multiply(wa, wb, wa);
+			wa.Store(out.Subview(first, lanes), lanes);
+		});
+	}
+
+	inline void MultiplyBatch(const Matrix4x4* a, const Matrix4x4* b, size_t count, Matrix4x4* out, size_t threadCount = 0){
+		MultiplyBatch(ConstMat4ArrayView(a, count), ConstMat4ArrayView(b, count), Mat4ArrayView(out, count), threadCount);
+	}
+
+	///	out[i] = inverse(mats[i]); determinants (optional) receives det(mats[i]).
+	inline void InverseBatch(ConstMat4ArrayView mats, Mat4ArrayView out,
+							 float* determinants = nullptr, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(WideInverseBatch);
+		assert(out.size() >= mats.size() && "Mismatched batch sizes!");
+		ForEachWidePack(mats.size(), threadCount, [&](size_t first, size_t lanes){
+			Matrix4x4xWide w;
+			alignas(32) float det[WIDE_MATRIX_LANES];
+			w.Load(mats.Subview(first, lanes), lanes);
+			Inverse(w, w, det);
+			w.Store(out.Subview(first, lanes), lanes);
+			if (determinants != nullptr)
+				for (size_t l = 0; l < lanes; ++l) determinants[first + l] = det[l];
+		});
+	}
+
+	inline void InverseBatch(const Matrix4x4* mats, size_t count, Matrix4x4* out,
+							 float* determinants = nullptr, size_t threadCount = 0){
+		InverseBatch(ConstMat4ArrayView(mats, count), Mat4ArrayView(out, count), determinants, threadCount);
+	}
+
+	///	out[i] = mats[i] * in[i]; out may alias in.
+	inline void TransformBatch(ConstMat4ArrayView mats, const Vector4* in, Vector4* out, size_t threadCount = 0){
+		FGML_SCOPED_TIMER(WideTransformBatch);
+		ForEachWidePack(mats.size(), threadCount, [&](size_t first, size_t lanes){
+			Matrix4x4xWide w;
+			w.Load(mats.Subview(first, lanes), lanes);
+			TransformVectors(w, in + first, out + first, lanes);
+		});
+	}
+
+	inline void TransformBatch(const Matrix4x4* mats, const Vector4* in, size_t count, Vector4* out, size_t threadCount = 0){
+		TransformBatch(ConstMat4ArrayView(mats, count), in, out, threadCount);
+	}
+	///
+	///	Batch entry points end
+	///
+};
+
+#endif // FGML_WIDEMATRIX_HPP_
\ No newline at end of file